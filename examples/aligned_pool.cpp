@@ -0,0 +1,72 @@
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+static bool aligned(const void* p, std::size_t alignment)
+{
+    return p && !(reinterpret_cast<std::uintptr_t>(p) & (alignment - 1));
+}
+
+int main()
+{
+    using btdef::allocator::pool;
+
+    {
+        // odd sizes in between, some requests open a new chunk
+        pool p(8192);
+        bool ok = true;
+        for (int round = 0; round < 100; ++round)
+        {
+            for (std::size_t alignment = 16;
+                alignment <= pool::max_alignment; alignment <<= 1)
+            {
+                p.malloc(static_cast<std::size_t>(round % 7) * 8 + 1);
+                void* a = p.aligned_malloc(24, alignment);
+                void* b = p.aligned_malloc(alignment * 2 + 8, alignment);
+                ok = ok && aligned(a, alignment) && aligned(b, alignment);
+            }
+        }
+        check("aligned_malloc 16..4096", ok);
+    }
+
+    {
+        pool p;
+        check("bad alignment", !p.aligned_malloc(16, 24) &&
+            !p.aligned_malloc(16, pool::max_alignment * 2) &&
+            !p.aligned_malloc(0, 64));
+        check("small alignment", aligned(p.aligned_malloc(3, 4), 4));
+    }
+
+    {
+        // in place while it is the last block, then moved
+        pool p;
+        bool ok = true;
+        for (std::size_t alignment = 16;
+            alignment <= pool::max_alignment; alignment <<= 1)
+        {
+            char* a = static_cast<char*>(p.aligned_malloc(100, alignment));
+            std::memset(a, 0x5a, 100);
+            char* b = static_cast<char*>(
+                p.aligned_realloc(a, 100, 200, alignment));
+            p.malloc(8);
+            char* c = static_cast<char*>(
+                p.aligned_realloc(b, 200, 300, alignment));
+            ok = ok && (a == b) && (b != c) && aligned(c, alignment) &&
+                (c[99] == 0x5a);
+        }
+        check("aligned_realloc", ok);
+    }
+
+    return failed ? 1 : 0;
+}
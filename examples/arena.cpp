@@ -0,0 +1,143 @@
+#include "btdef/allocator/basic_arena.hpp"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+// destruction order
+static std::vector<int> order;
+
+struct noisy
+{
+    int id;
+    std::uint64_t pad;
+
+    explicit noisy(int i) noexcept
+        : id(i)
+    {   }
+
+    ~noisy()
+    {
+        order.push_back(id);
+    }
+};
+
+// the same size, nothing to destroy
+struct plain
+{
+    int id;
+    std::uint64_t pad;
+};
+
+static bool reversed(int count)
+{
+    if (order.size() != static_cast<std::size_t>(count))
+        return false;
+    for (int i = 0; i < count; ++i)
+        if (order[static_cast<std::size_t>(i)] != count - i)
+            return false;
+    return true;
+}
+
+int main()
+{
+    using btdef::allocator::arena;
+
+    {
+        arena a;
+        for (int i = 1; i <= 5; ++i)
+        {
+            a.make<noisy>(i);
+            // no record for these
+            a.make<plain>(plain{-i, 0});
+        }
+        a.clear();
+        check("clear in reverse order", reversed(5));
+
+        order.clear();
+        for (int i = 1; i <= 3; ++i)
+            a.make<noisy>(i);
+        a.rewind();
+        check("rewind in reverse order", reversed(3));
+
+        order.clear();
+        a.make<noisy>(1);
+        a.make<noisy>(2);
+    }
+    check("destructor in reverse order", reversed(2));
+
+    {
+        // a thunk record is two pointers in front of the object
+        arena a;
+        a.make<plain>(plain{});
+        const std::size_t trivial = a.size();
+        a.make<noisy>(0);
+        const std::size_t record = a.size() - trivial;
+        check("no thunk for trivial types",
+            (trivial == sizeof(plain)) &&
+            (record == sizeof(noisy) + 2 * sizeof(void*)));
+
+        order.clear();
+        a.clear();
+        check("only non trivial destroyed",
+            (order.size() == 1) && (order[0] == 0));
+    }
+
+    const std::size_t count = 10000000;
+    order.reserve(count + 1);
+
+    test("new/delete", count, [](std::size_t counter) {
+        auto p = std::make_unique<noisy>(static_cast<int>(counter));
+        std::size_t result = static_cast<std::size_t>(p->id);
+        p.reset();
+        order.clear();
+        return result;
+    });
+
+    arena a;
+    test("arena make", count, [&](std::size_t counter) {
+        auto p = a.make<noisy>(static_cast<int>(counter));
+        std::size_t result = static_cast<std::size_t>(p->id);
+        if ((counter & 1023) == 0)
+        {
+            a.rewind();
+            order.clear();
+        }
+        return result;
+    });
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#include "btdef/util/civil.hpp"
+
+#include <ctime>
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using namespace btdef::util;
+
+    const std::size_t count = 10000000;
+    // a day and a second apart, so no call hits a cached day
+    const std::time_t base = 1500000000;
+    auto at = [&](std::size_t counter) {
+        return base + static_cast<std::time_t>(counter) * 86401;
+    };
+
+    test("gmtime_r", count, [&](std::size_t counter) {
+        std::time_t t = at(counter);
+        std::tm tms;
+        ::gmtime_r(&t, &tms);
+        return static_cast<std::size_t>(tms.tm_year + tms.tm_mday);
+    });
+
+    test("civil::to_tm", count, [&](std::size_t counter) {
+        std::tm tms = civil::to_tm(at(counter));
+        return static_cast<std::size_t>(tms.tm_year + tms.tm_mday);
+    });
+
+    test("timegm", count, [&](std::size_t counter) {
+        std::tm tms = civil::to_tm(at(counter));
+        return static_cast<std::size_t>(::timegm(&tms));
+    });
+
+    test("civil::from_tm", count, [&](std::size_t counter) {
+        std::tm tms = civil::to_tm(at(counter));
+        return static_cast<std::size_t>(civil::from_tm(tms));
+    });
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+using std::chrono::milliseconds;
+using std::chrono::system_clock;
+
+// t is within the tick of a coarse clock from the system clock
+template<class T>
+static bool near(T t)
+{
+    const auto d = system_clock::now() - t;
+    return (d > -milliseconds(50)) && (d < milliseconds(50));
+}
+
+static void sleep(int msec)
+{
+    std::this_thread::sleep_for(milliseconds(msec));
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::time::coarse_clock;
+    using btdef::time::cached_clock;
+
+    check("coarse_clock", near(coarse_clock::now()));
+
+    {
+        // no ticker, no update, it follows the coarse clock
+        const auto a = cached_clock::now();
+        sleep(30);
+        const auto b = cached_clock::now();
+        check("cached_clock without ticker", near(a) && near(b) &&
+            (b - a >= milliseconds(20)));
+    }
+
+    {
+        // update() holds the time until the next one
+        const auto a = cached_clock::update();
+        sleep(10);
+        const auto b = cached_clock::now();
+        const auto c = cached_clock::update();
+        check("cached_clock update", (a == b) && (c > b));
+    }
+
+    {
+        check("cached_clock start", cached_clock::start(milliseconds(1)) &&
+            !cached_clock::start());
+        const auto a = cached_clock::now();
+        sleep(30);
+        const auto b = cached_clock::now();
+        check("cached_clock ticker", near(b) && (b - a >= milliseconds(20)));
+
+        cached_clock::stop();
+        const auto c = cached_clock::now();
+        sleep(30);
+        check("cached_clock after stop",
+            cached_clock::now() - c >= milliseconds(20));
+    }
+
+    {
+        const date d = date::now<cached_clock>();
+        check("date::now<cached_clock>", near(d.time_point()));
+        check("date::log_time", date::log_time().size() ==
+            date::now().local_json().size());
+    }
+
+    const std::size_t count = 10000000;
+
+    test("system_clock::now()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(
+            system_clock::now().time_since_epoch().count() & 1);
+    });
+
+    test("coarse_clock::now()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(
+            coarse_clock::now().time_since_epoch().count() & 1);
+    });
+
+    cached_clock::start();
+    test("cached_clock::now()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(
+            cached_clock::now().time_since_epoch().count() & 1);
+    });
+
+    test("date::log_time()", count / 10, [&](std::size_t) {
+        return date::log_time().size();
+    });
+    cached_clock::stop();
+
+    test("date::log_time() coarse", count / 10, [&](std::size_t) {
+        return date::log_time().size();
+    });
+
+    return failed ? 1 : 0;
+}
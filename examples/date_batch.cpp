@@ -0,0 +1,200 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <iostream>
+
+// fn goes over rows timestamps, the time is per row
+template <typename F>
+void test(const char* what, std::size_t count, std::size_t rows, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one row - "
+        << static_cast<double>(nsec.count()) / static_cast<double>(
+            count * rows) << " nsec"
+        << std::endl;
+}
+
+// every parse_errc with a malformed input
+static int check_errors()
+{
+    using btdef::date;
+    using btdef::date_ns;
+    using btdef::parse_errc;
+
+    struct sample
+    {
+        const char* text;
+        parse_errc rc;
+    };
+
+    static const sample samples[] = {
+        {"2015-11-27T19:16:51.123Z", parse_errc::ok},
+        {"2015-11-27", parse_errc::ok},
+        {"2015-11-27T19", parse_errc::bad_length},
+        {"2015-11", parse_errc::bad_length},
+        {"2015/11/27", parse_errc::bad_format},
+        {"2015-11-27 19:16:51Z", parse_errc::bad_format},
+        {"2015-13-27T19:16:51Z", parse_errc::out_of_range},
+        {"2015-02-29T19:16:51Z", parse_errc::out_of_range},
+        {"2015-11-27T24:16:51Z", parse_errc::out_of_range},
+        {"2015-11-27T19:16:51.Z", parse_errc::bad_fraction},
+        {"2015-11-27T19:16:51+24:00", parse_errc::bad_zone},
+        {"2015-11-27T19:16:51+03:", parse_errc::bad_zone},
+        {"2015-11-27T19:16:51X", parse_errc::bad_zone},
+        {"2015-11-27T19:16:51Zx", parse_errc::trailing},
+        {"2015-11-27T19:16:51+0300 ", parse_errc::trailing}
+    };
+
+    int failed = 0;
+    for (auto& s : samples)
+    {
+        const std::string_view text(s.text);
+
+        date d;
+        date_ns dn;
+        const parse_errc rc = date::try_parse(text, d);
+        const parse_errc rc_ns = date_ns::try_parse(text, dn);
+
+        bool thrown = false;
+        try
+        {
+            date::parse(text);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+
+        std::int64_t out;
+        std::uint8_t valid;
+        btdef::parse_batch(&text, 1, &out, &valid);
+
+        const bool ok = (rc == s.rc) && (rc_ns == s.rc) &&
+            (thrown == (rc != parse_errc::ok)) &&
+            ((valid != 0) == (rc == parse_errc::ok));
+        std::cout << s.text << " - " << static_cast<int>(rc) << " "
+            << static_cast<int>(rc_ns) << (ok ? " ok" : " FAIL")
+            << std::endl;
+        if (!ok)
+            ++failed;
+    }
+
+    return failed;
+}
+
+// rows out of the range of date, alone and in a block of eight
+template<class Duration>
+static int check_range()
+{
+    using btdef::date;
+    using btdef::parse_errc;
+
+    static const char* samples[] = {
+        "1600-01-01T00:00:00.000Z",
+        "1677-09-21T00:12:44.000Z",
+        "1677-09-21T00:12:45.000Z",
+        "2262-04-11T23:47:15.000Z",
+        "2262-04-11T23:47:16.000Z",
+        "9999-12-31T23:59:59.999Z"
+    };
+
+    int failed = 0;
+    for (auto text : samples)
+    {
+        date d;
+        const bool ok = date::try_parse(text, d) == parse_errc::ok;
+
+        std::string_view rows[8];
+        for (auto& r : rows)
+            r = text;
+        std::int64_t out[8];
+        std::uint8_t valid[8];
+        const std::size_t n = btdef::parse_batch<Duration>(rows, 8,
+            out, valid);
+
+        const bool same = (n == (ok ? 8u : 0u)) && (valid[0] == ok) &&
+            (!ok || (out[0] == std::chrono::duration_cast<Duration>(
+                d.time_point().time_since_epoch()).count()));
+        std::cout << text << " - " << (ok ? "in range" : "out of range")
+            << (same ? " ok" : " FAIL") << std::endl;
+        if (!same)
+            ++failed;
+    }
+
+    return failed;
+}
+
+int main()
+{
+    using btdef::date;
+
+    if (check_errors() || check_range<std::chrono::milliseconds>() ||
+        check_range<std::chrono::nanoseconds>())
+        return 1;
+
+    const std::size_t rows = 100000;
+    const std::size_t width = 24;
+    const std::size_t count = 100;
+
+    // a fixed width column of YYYY-MM-DDThh:mm:ss.mmmZ
+    std::string column;
+    std::vector<std::string_view> views;
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        date d(static_cast<date::value_t>(1500000000000ll + i * 8640123ll));
+        column += d.to_json().c_str();
+    }
+    for (std::size_t i = 0; i < rows; ++i)
+        views.emplace_back(column.data() + i * width, width);
+
+    std::vector<std::int64_t> out(rows);
+    std::vector<std::uint8_t> valid(rows);
+
+    test("date::parse", count, rows, [&](std::size_t) {
+        std::size_t result = 0;
+        for (auto& v : views)
+            result += static_cast<std::size_t>(date::parse(v).time() & 1);
+        return result;
+    });
+
+    test("date::try_parse", count, rows, [&](std::size_t) {
+        std::size_t result = 0;
+        for (auto& v : views)
+        {
+            date d;
+            if (date::try_parse(v, d) == btdef::parse_errc::ok)
+                result += static_cast<std::size_t>(d.time() & 1);
+        }
+        return result;
+    });
+
+    test("parse_batch string_view", count, rows, [&](std::size_t) {
+        return btdef::parse_batch(views.data(), rows,
+            out.data(), valid.data());
+    });
+
+    test("parse_batch stride", count, rows, [&](std::size_t) {
+        return btdef::parse_batch(column.data(), width, width, rows,
+            out.data(), valid.data());
+    });
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::date_ns;
+
+    const std::size_t count = 10000000;
+    // a stamp every 250 nsec
+    const date_ns::value_t base = date_ns::now().time();
+    auto at = [&](std::size_t counter) {
+        return date_ns(base + static_cast<date_ns::value_t>(counter) * 250);
+    };
+    auto sum = [](const btdef::util::text& t) {
+        return static_cast<std::size_t>(t.data()[18] + t.data()[22]);
+    };
+
+    test("date_ns::now()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(date_ns::now().time() & 1);
+    });
+
+    test("d.to_json(3)", count, [&](std::size_t counter) {
+        return sum(at(counter).to_json(3));
+    });
+
+    test("d.to_json(9)", count, [&](std::size_t counter) {
+        return sum(at(counter).to_json(9));
+    });
+
+    test("d.local_json(6)", count, [&](std::size_t counter) {
+        return sum(at(counter).local_json(6));
+    });
+
+    test("date_ns(d.to_timeval())", count, [&](std::size_t counter) {
+        return static_cast<std::size_t>(
+            date_ns(at(counter).to_timeval()).time() / 1000 & 1);
+    });
+
+    const btdef::util::text json = date_ns::now().to_json();
+    const std::string_view str(json.data(), json.size());
+    test("date_ns::parse()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(date_ns::parse(str).time() & 1);
+    });
+
+    return 0;
+}
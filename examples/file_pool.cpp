@@ -0,0 +1,111 @@
+#include "btdef/allocator/file_pool.hpp"
+
+#include <new>
+#include <iostream>
+#include <unistd.h>
+
+using btdef::allocator::file_pool;
+using btdef::allocator::offset_ptr;
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+// ring of nodes, a single node points to itself
+struct node
+{
+    offset_ptr<node> next;
+    offset_ptr<node> none;
+    int value;
+};
+
+struct table
+{
+    offset_ptr<node> self;
+    offset_ptr<node> ring;
+    std::size_t size;
+};
+
+static std::size_t ring_sum(const node* head, std::size_t limit)
+{
+    std::size_t sum = 0;
+    const node* n = head;
+    for (std::size_t i = 0; n && (i < limit); ++i)
+    {
+        sum += static_cast<std::size_t>(n->value);
+        n = n->next.get();
+        if (n == head)
+            break;
+    }
+    return sum;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = (argc > 1) ? argv[1] : "/tmp/btdef_file_pool.pool";
+    ::unlink(path);
+
+    {
+        offset_ptr<node> p;
+        offset_ptr<node> q = nullptr;
+        check("default is nullptr", !p && !q && !p.get() && (p == q));
+    }
+
+    {
+        file_pool pool(path);
+
+        table* t = new (pool.malloc(sizeof(table))) table{};
+
+        // the first member points to its own object, distance zero
+        node* single = new (pool.malloc(sizeof(node))) node{};
+        single->next = single;
+        single->value = 7;
+        check("self reference", single->next &&
+            (single->next.get() == single) && !single->none);
+
+        node* first = nullptr;
+        node* last = nullptr;
+        for (int i = 1; i <= 10; ++i)
+        {
+            node* n = new (pool.malloc(sizeof(node))) node{};
+            n->value = i;
+            if (last)
+                last->next = n;
+            else
+                first = n;
+            last = n;
+        }
+        last->next = first;
+
+        t->self = single;
+        t->ring = first;
+        t->size = 10;
+        pool.set_root(t);
+        check("sync", pool.sync());
+    }
+
+    {
+        file_pool pool(path);
+        const table* t = pool.root<table>();
+        check("reopen", !pool.created() && t && (t->size == 10));
+
+        const node* single = t->self.get();
+        check("self reference after reopen", single &&
+            (single->next.get() == single) && !single->none &&
+            (ring_sum(single, 100) == 7));
+        check("ring after reopen", ring_sum(t->ring.get(), 100) == 55);
+
+        // a copy points to the same node from its own place
+        offset_ptr<node> copy = single->next;
+        check("copy", (copy == single->next) && (copy.get() == single));
+    }
+
+    ::unlink(path);
+
+    return failed ? 1 : 0;
+}
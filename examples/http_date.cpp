@@ -0,0 +1,57 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+
+    const std::size_t count = 10000000;
+    // a server answering a hundred requests per millisecond
+    const date::value_t base = date::now().time();
+    auto at = [&](std::size_t counter) {
+        return date(base + static_cast<date::value_t>(counter / 100));
+    };
+    auto sum = [](const btdef::util::text& t) {
+        return static_cast<std::size_t>(t.data()[23] + t.data()[24]);
+    };
+
+    test("date::utc(d).text()", count, [&](std::size_t counter) {
+        return sum(date::utc(at(counter)).text());
+    });
+
+    test("d.http_text()", count, [&](std::size_t counter) {
+        return sum(at(counter).http_text());
+    });
+
+    const btdef::util::text header = date::now().http_text();
+    const std::string_view str(header.data(), header.size());
+    test("date::parse_http()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(date::parse_http(str).time() & 1);
+    });
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "btdef/arena.hpp"
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace std::literals;
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    const std::size_t count = 10000000;
+
+    // small per-call workspace: a few ints and a short string
+    test("std::vector", count, [](std::size_t counter) {
+        std::vector<std::size_t> v;
+        for (std::size_t i = 0; i < 16; ++i)
+            v.push_back(counter + i);
+
+        std::string s;
+        s += "counter="sv;
+        s += std::to_string(counter);
+        s += " some longer suffix to leave sso"sv;
+
+        return v.back() + s.size();
+    });
+
+    test("arena_vector", count, [](std::size_t counter) {
+        btdef::inline_pool<1024> ws;
+
+        btdef::arena_vector<std::size_t> v{
+            btdef::arena_allocator<std::size_t>{ws}};
+        for (std::size_t i = 0; i < 16; ++i)
+            v.push_back(counter + i);
+
+        btdef::arena_string s{btdef::arena_allocator<char>{ws}};
+        s += "counter="sv;
+        s += std::to_string(counter);
+        s += " some longer suffix to leave sso"sv;
+
+        return v.back() + s.size();
+    });
+
+    return 0;
+}
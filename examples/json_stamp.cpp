@@ -0,0 +1,59 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+
+    const std::size_t count = 10000000;
+    // four stamps per millisecond, like a busy log
+    const date::value_t base = date::now().time();
+    auto at = [&](std::size_t counter) {
+        return date(base + static_cast<date::value_t>(counter / 4));
+    };
+    auto sum = [](const btdef::util::text& t) {
+        return static_cast<std::size_t>(t.data()[18] + t.data()[22]);
+    };
+
+    test("date::utc(d).to_json()", count, [&](std::size_t counter) {
+        return sum(date::utc(at(counter)).to_json());
+    });
+
+    test("d.to_json()", count, [&](std::size_t counter) {
+        return sum(at(counter).to_json());
+    });
+
+    test("date::local(d).to_json()", count, [&](std::size_t counter) {
+        return sum(date::local(at(counter)).to_json());
+    });
+
+    test("d.local_json()", count, [&](std::size_t counter) {
+        return sum(at(counter).local_json());
+    });
+
+    return 0;
+}
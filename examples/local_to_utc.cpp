@@ -0,0 +1,99 @@
+#include "btdef/date.hpp"
+
+#include <ctime>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::util::time::tzif;
+
+    const std::size_t count = 2000000;
+    // wall clock times an hour and a second apart
+    const std::tm base = date::local(date::now()).data();
+    auto at = [&](std::size_t counter) {
+        std::tm tms = base;
+        tms.tm_hour -= static_cast<int>(counter % 10000);
+        tms.tm_sec += static_cast<int>(counter % 60);
+        tms.tm_isdst = -1;
+        return tms;
+    };
+
+    test("std::mktime", count, [&](std::size_t counter) {
+        std::tm tms = at(counter);
+        return static_cast<std::size_t>(std::mktime(&tms) & 1);
+    });
+
+    test("date(tm)", count, [&](std::size_t counter) {
+        return static_cast<std::size_t>(date(at(counter)).time() & 1);
+    });
+
+    // wall clock times a minute apart around the transitions of 2000-2030
+    std::vector<std::tm> near;
+    long gmtoff = 0;
+    for (std::time_t t = 946684800; t < 1924992000; t += 3600)
+    {
+        std::tm tms{};
+        ::localtime_r(&t, &tms);
+        if ((t != 946684800) && (tms.tm_gmtoff != gmtoff))
+        {
+            for (std::time_t u = t - 3 * 3600; u < t + 3 * 3600; u += 60)
+            {
+                std::tm m{};
+                ::localtime_r(&u, &m);
+                m.tm_isdst = -1;
+                near.push_back(m);
+            }
+        }
+        gmtoff = tms.tm_gmtoff;
+    }
+
+    if (!near.empty())
+    {
+        test("std::mktime near transitions", count, [&](std::size_t counter) {
+            std::tm tms = near[counter % near.size()];
+            return static_cast<std::size_t>(std::mktime(&tms) & 1);
+        });
+
+        test("date(tm) near transitions", count, [&](std::size_t counter) {
+            return static_cast<std::size_t>(
+                date(near[counter % near.size()]).time() & 1);
+        });
+    }
+
+    const tzif& zone = tzif::find("Europe/Berlin");
+    test("date(tm, zone)", count, [&](std::size_t counter) {
+        return static_cast<std::size_t>(date(at(counter), zone).time() & 1);
+    });
+
+    test("date(local)", count, [&](std::size_t counter) {
+        date::local l(date(static_cast<date::value_t>(counter) * 3600000));
+        return static_cast<std::size_t>(date(l).time() & 1);
+    });
+
+    return 0;
+}
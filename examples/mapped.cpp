@@ -0,0 +1,120 @@
+#include "btdef/allocator/basic_pool.hpp"
+#include "btdef/allocator/mapped.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+using btdef::allocator::mapped;
+typedef btdef::allocator::basic_pool<mapped<char>> mapped_pool;
+
+// fills a chunk of the pool and returns its first block
+static char* fill(mapped_pool& pool, std::size_t size)
+{
+    char* p = static_cast<char*>(pool.malloc(size));
+    if (p)
+        std::memset(p, 0x5a, size);
+    return p;
+}
+
+int main()
+{
+    const std::size_t huge = mapped<char>::huge_page_size();
+    check("huge page size", huge && !(huge & (huge - 1)) &&
+        (huge >= 4096));
+
+    {
+        mapped<char> alloc;
+        check("release is opt-in", !(alloc.flags() & mapped<char>::release));
+    }
+
+    const std::size_t chunk = 1024 * 1024;
+    const std::size_t block = chunk / 2;
+
+    {
+        // the kept chunk still holds its data, no page faults
+        mapped<char> alloc;
+        mapped_pool pool(chunk, &alloc);
+        char* p = fill(pool, block);
+        pool.reset();
+        char* q = static_cast<char*>(pool.malloc(block));
+        check("chunk kept", p && (p == q));
+        check("pages kept", q && (q[block - 1] == 0x5a));
+    }
+
+    {
+        // released pages come back zeroed
+        mapped<char> alloc(mapped<char>::huge_transparent |
+            mapped<char>::release);
+        mapped_pool pool(chunk, &alloc);
+        char* p = fill(pool, block);
+        pool.reset();
+        char* q = static_cast<char*>(pool.malloc(block));
+        check("chunk kept with release", p && (p == q));
+        check("pages released", q && (q[block - 1] == 0));
+    }
+
+    {
+        // falls back to regular pages without reserved huge pages
+        mapped<char> alloc(mapped<char>::huge_tlb);
+        mapped_pool pool(huge - 64, &alloc);
+        char* p = fill(pool, block);
+        check("huge_tlb", p != nullptr);
+        pool.reset();
+        char* q = static_cast<char*>(pool.malloc(block));
+        check("single huge page chunk never released",
+            (p == q) && q && (q[block - 1] == 0x5a));
+    }
+
+    const std::size_t count = 2000;
+
+    mapped<char> keep;
+    mapped_pool keep_pool(chunk, &keep);
+    test("reset", count, [&](std::size_t counter) {
+        char* p = fill(keep_pool, block);
+        keep_pool.reset();
+        return static_cast<std::size_t>(p[counter % block]);
+    });
+
+    mapped<char> release(mapped<char>::release);
+    mapped_pool release_pool(chunk, &release);
+    test("reset with release", count, [&](std::size_t counter) {
+        char* p = fill(release_pool, block);
+        release_pool.reset();
+        return static_cast<std::size_t>(p[counter % block]);
+    });
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+#include "btdef/allocator/numa.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+// the node holding the page at ptr, -1 if unknown
+static int page_node(void* ptr)
+{
+#if defined(__linux__)
+    // MPOL_F_NODE | MPOL_F_ADDR
+    int node = -1;
+    if (::syscall(SYS_get_mempolicy, &node, nullptr, 0ul, ptr, 3ul) == 0)
+        return node;
+#else
+    (void)ptr;
+#endif
+    return -1;
+}
+
+int main()
+{
+    using btdef::allocator::numa;
+    using btdef::allocator::numa_arena;
+
+    const int count = numa<char>::node_count();
+    std::cout << "nodes: " << count << std::endl;
+
+    const std::size_t size = 1 << 20;
+
+    if (count == 1)
+    {
+        // plain malloc, node and strict change nothing
+        numa<char> any;
+        numa<char> strict(0, true);
+        char* a = any.allocate(size);
+        char* b = strict.allocate(size);
+        if (a)
+            std::memset(a, 1, size);
+        if (b)
+            std::memset(b, 1, size);
+        check("single node", a && b && (numa<char>::current_node() == 0));
+        any.deallocate(a, size);
+        strict.deallocate(b, size);
+    }
+    else
+    {
+        bool ok = true;
+        for (int node = 0; node < count; ++node)
+        {
+            numa<char> strict(node, true);
+            char* p = strict.allocate(size);
+            // a node may be absent from the allowed set
+            if (!p)
+                continue;
+
+            // the first touch places the pages
+            std::memset(p, 1, size);
+            ok = ok && (page_node(p) == node) &&
+                (page_node(p + size - 1) == node);
+            strict.deallocate(p, size);
+        }
+        check("strict placement", ok);
+
+        numa<char> missing(count + 1, true);
+        check("strict to a missing node fails",
+            missing.allocate(size) == nullptr);
+    }
+
+    {
+        numa_arena arena(64 * 1024);
+        char* p = static_cast<char*>(arena.malloc(1000));
+        if (p)
+            std::memset(p, 1, 1000);
+        check("arena per node", p &&
+            (arena.size() == static_cast<std::size_t>(count)));
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+#include "btdef/util/pool_vector.hpp"
+#include "btdef/util/pool_string.hpp"
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+using namespace std::literals;
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+struct alignas(64) line
+{
+    std::uint64_t value;
+};
+
+// counts live objects, not trivially copyable
+struct item
+{
+    static int live;
+    std::string text;
+
+    explicit item(std::string t)
+        : text(std::move(t))
+    {
+        ++live;
+    }
+
+    item(item&& other) noexcept
+        : text(std::move(other.text))
+    {
+        ++live;
+    }
+
+    ~item()
+    {
+        --live;
+    }
+};
+
+int item::live = 0;
+
+int main()
+{
+    using btdef::util::pool_vector;
+    using btdef::util::basic_pool_string;
+
+    {
+        // the only block of the pool grows where it is
+        btdef::allocator::pool pool;
+        pool_vector<int> v(pool);
+        v.reserve(8);
+        const int* p = v.data();
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i);
+        check("grow in place", (v.data() == p) && (v.capacity() >= 100));
+    }
+
+    {
+        // another block after the buffer, it has to move
+        btdef::allocator::pool pool;
+        pool_vector<int> v(pool);
+        for (int i = 0; i < 8; ++i)
+            v.push_back(i);
+        const int* p = v.data();
+        pool.malloc(16);
+        v.push_back(8);
+
+        bool same = true;
+        for (int i = 0; i < 9; ++i)
+            same = same && (v[static_cast<std::size_t>(i)] == i);
+        check("move to a new block", (v.data() != p) && same);
+    }
+
+    {
+        // non trivial elements are moved and the old ones destroyed
+        btdef::allocator::pool pool;
+        {
+            pool_vector<item> v(pool);
+            v.emplace_back("first string longer than sso buffer"s);
+            pool.malloc(16);
+            for (int i = 0; i < 20; ++i)
+                v.emplace_back(std::to_string(i));
+            check("move elements", (item::live == 21) &&
+                (v.front().text == "first string longer than sso buffer") &&
+                (v.back().text == "19"));
+        }
+        check("destroy elements", item::live == 0);
+    }
+
+    {
+        // over-aligned elements, in place and after a move
+        btdef::allocator::pool pool;
+        pool_vector<line> v(pool);
+        pool.malloc(1);
+        bool aligned = true;
+        for (std::uint64_t i = 0; i < 50; ++i)
+        {
+            v.push_back(line{i});
+            aligned = aligned &&
+                (reinterpret_cast<std::uintptr_t>(v.data()) % 64 == 0);
+            if (i == 20)
+                pool.malloc(1);
+        }
+        check("over-aligned", aligned && (v.back().value == 49) &&
+            (v[20].value == 20));
+    }
+
+    {
+        btdef::allocator::pool pool;
+        basic_pool_string<> s(pool);
+        s += "counter="sv;
+        const char* p = s.c_str();
+        for (int i = 0; i < 10; ++i)
+            s += " some longer suffix"sv;
+        const bool in_place = (s.c_str() == p);
+        pool.malloc(16);
+        s.append(100, 'x');
+        check("pool_string", in_place && (s.c_str() != p) &&
+            (s.str().size() == 8 + 19 * 10 + 100));
+    }
+
+    const std::size_t count = 1000000;
+
+    test("std::vector", count, [](std::size_t counter) {
+        std::vector<std::size_t> v;
+        for (std::size_t i = 0; i < 64; ++i)
+            v.push_back(counter + i);
+        return v.back();
+    });
+
+    btdef::allocator::pool pool;
+    test("pool_vector", count, [&](std::size_t counter) {
+        std::size_t result;
+        {
+            pool_vector<std::size_t> v(pool);
+            for (std::size_t i = 0; i < 64; ++i)
+                v.push_back(counter + i);
+            result = v.back();
+        }
+        pool.reset();
+        return result;
+    });
+
+    return failed ? 1 : 0;
+}
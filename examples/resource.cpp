@@ -0,0 +1,165 @@
+#include "btdef/allocator/resource.hpp"
+
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+static bool aligned(const void* p, std::size_t alignment)
+{
+    return p && !(reinterpret_cast<std::uintptr_t>(p) & (alignment - 1));
+}
+
+// counts the calls on the way to the pool resource
+class counting final
+    : public std::pmr::memory_resource
+{
+    std::pmr::memory_resource* upstream_;
+
+public:
+    std::size_t allocate_{};
+    std::size_t deallocate_{};
+    std::size_t bytes_{};
+
+    explicit counting(std::pmr::memory_resource* upstream) noexcept
+        : upstream_(upstream)
+    {   }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocate_;
+        bytes_ += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes,
+        std::size_t alignment) override
+    {
+        ++deallocate_;
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other)
+        const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+struct alignas(64) line
+{
+    std::uint64_t value;
+};
+
+int main()
+{
+    using btdef::allocator::pool;
+    using btdef::allocator::resource;
+
+    // anything that misses the arena throws
+    std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    {
+        pool p;
+        resource r(p);
+        counting c(&r);
+
+        std::pmr::vector<int> v(&c);
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        const std::size_t vector_calls = c.allocate_;
+
+        std::pmr::string s(&c);
+        s.assign(1000, 'x');
+        const std::size_t string_calls = c.allocate_ - vector_calls;
+
+        std::pmr::unordered_map<int, int> m(&c);
+        for (int i = 0; i < 1000; ++i)
+            m.emplace(i, i);
+        const std::size_t map_calls = c.allocate_ - vector_calls -
+            string_calls;
+
+        check("vector, string and map share the arena",
+            vector_calls && string_calls && (map_calls >= 1000) &&
+            (p.size() >= c.bytes_));
+    }
+
+    {
+        // inner containers take the allocator of the outer one
+        pool p;
+        resource r(p);
+        counting c(&r);
+
+        std::pmr::vector<std::pmr::string> v(&c);
+        v.reserve(100);
+        const std::size_t outer = c.allocate_;
+        for (int i = 0; i < 100; ++i)
+            v.emplace_back(100, 'a' + static_cast<char>(i % 26));
+
+        std::pmr::unordered_map<int, std::pmr::vector<int>> m(&c);
+        m[1].assign(100, 1);
+
+        bool same = (m[1].get_allocator().resource() == &c);
+        for (auto& s : v)
+            same = same && (s.get_allocator().resource() == &c);
+
+        check("nested containers propagate", same &&
+            (c.allocate_ >= outer + 100));
+    }
+
+    {
+        pool p;
+        resource r(p);
+
+        bool ok = true;
+        for (std::size_t alignment = 1;
+            alignment <= pool::max_alignment; alignment <<= 1)
+        {
+            p.malloc(8);
+            ok = ok && aligned(r.allocate(100, alignment), alignment) &&
+                aligned(r.allocate(0, alignment), alignment);
+        }
+        check("over-aligned allocate", ok);
+
+        bool thrown = false;
+        try
+        {
+            void* ptr = r.allocate(100, pool::max_alignment * 2);
+            thrown = (ptr == nullptr);
+        }
+        catch (const std::bad_alloc&)
+        {
+            thrown = true;
+        }
+        check("alignment above max_alignment", thrown);
+
+        std::pmr::vector<line> v(&r);
+        p.malloc(8);
+        for (std::uint64_t i = 0; i < 100; ++i)
+            v.push_back(line{i});
+        check("over-aligned elements", aligned(v.data(), alignof(line)) &&
+            (v[99].value == 99));
+    }
+
+    {
+        pool p, q;
+        resource a(p), b(p), c(q);
+        check("equal by pool", a.is_equal(b) && !a.is_equal(c));
+    }
+
+    std::pmr::set_default_resource(nullptr);
+
+    return failed ? 1 : 0;
+}
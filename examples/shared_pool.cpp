@@ -0,0 +1,79 @@
+#include "btdef/allocator/basic_pool.hpp"
+#include "btdef/allocator/basic_shared_pool.hpp"
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// every thread allocates the same mix of small blocks
+// shared_pool - one arena for all threads
+// pool - an arena per thread
+// malloc - malloc/free from the system allocator
+
+template <typename F>
+void test(const char* what, std::size_t threads, std::size_t count, F&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i)
+        workers.emplace_back([&]{ fn(count); });
+    for (auto& w : workers)
+        w.join();
+
+    const auto stop = std::chrono::steady_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " threads - " << threads
+        << ", total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / (count * threads) << " nsec"
+        << std::endl;
+}
+
+static std::size_t block_size(std::size_t i) noexcept
+{
+    return 8 + (i * 37) % 120;
+}
+
+int main()
+{
+    const std::size_t count = 1000000;
+    std::size_t max_threads = std::thread::hardware_concurrency();
+    if (!max_threads)
+        max_threads = 1;
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        btdef::allocator::shared_pool shared;
+        test("shared_pool", threads, count, [&](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                *static_cast<char*>(shared.malloc(block_size(i))) = 1;
+        });
+        shared.clear();
+
+        test("pool", threads, count, [](std::size_t n) {
+            btdef::allocator::pool local;
+            for (std::size_t i = 0; i < n; ++i)
+                *static_cast<char*>(local.malloc(block_size(i))) = 1;
+        });
+
+        test("malloc", threads, count, [](std::size_t n) {
+            std::vector<void*> blocks(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                blocks[i] = std::malloc(block_size(i));
+                *static_cast<char*>(blocks[i]) = 1;
+            }
+            for (auto p : blocks)
+                std::free(p);
+        });
+    }
+
+    return 0;
+}
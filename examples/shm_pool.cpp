@@ -0,0 +1,139 @@
+#include "btdef/allocator/shm_pool.hpp"
+
+#include <new>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <unistd.h>
+
+using btdef::allocator::shm_pool;
+using btdef::allocator::shm_view;
+using btdef::allocator::offset_ptr;
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+struct entry
+{
+    offset_ptr<entry> next;
+    std::uint64_t key;
+    std::uint64_t value;
+};
+
+struct table
+{
+    offset_ptr<entry> first;
+    std::uint64_t size;
+};
+
+// a list of count entries, key i and value i * i
+static table* build(shm_pool& pool, std::uint64_t count)
+{
+    table* t = new (pool.malloc(sizeof(table))) table{};
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        entry* e = new (pool.malloc(sizeof(entry))) entry{};
+        e->key = i;
+        e->value = i * i;
+        e->next = t->first.get();
+        t->first = e;
+    }
+    t->size = count;
+    return t;
+}
+
+static bool verify(const table* t, std::uint64_t count)
+{
+    if (!t || (t->size != count))
+        return false;
+
+    std::uint64_t n = 0;
+    for (const entry* e = t->first.get(); e; e = e->next.get(), ++n)
+    {
+        const std::uint64_t key = count - n - 1;
+        if ((e->key != key) || (e->value != key * key))
+            return false;
+    }
+    return n == count;
+}
+
+int main()
+{
+    {
+        // the size_t constructor, not an fd
+        shm_pool pool(1 << 20);
+        check("anonymous segment", (pool.fd() >= 0) &&
+            (pool.capacity() == (1 << 20)) &&
+            (pool.size() == shm_pool::header_size));
+
+        check("empty root", pool.root<table>() == nullptr);
+        pool.set_root(build(pool, 100));
+
+        // the view owns its descriptor
+        shm_view view = shm_view::attach_fd(::dup(pool.fd()));
+        const table* t = view.root<table>();
+        check("view reads back", verify(t, 100));
+        check("same offsets", view.offset(t) ==
+            pool.offset(pool.root<table>()));
+
+        // a second writer continues after the first one
+        shm_pool writer = shm_pool::attach_fd(::dup(pool.fd()));
+        const std::size_t before = pool.size();
+        writer.set_root(build(writer, 10));
+        check("second writer", (writer.size() > before) &&
+            (pool.size() == writer.size()) && verify(view.root<table>(), 10));
+
+        check("out of capacity", pool.malloc(2 << 20) == nullptr);
+
+        void* p = pool.aligned_malloc(100, 4096);
+        check("aligned", p && (pool.offset(p) % 4096 == 0));
+    }
+
+    {
+        const std::string name = "/btdef-shm-example-" +
+            std::to_string(::getpid());
+        shm_pool::unlink(name.c_str());
+        {
+            shm_pool pool(name.c_str(), 1 << 20);
+            pool.set_root(build(pool, 50));
+        }
+
+        // the segment stays until unlink
+        shm_view view(name.c_str());
+        check("named segment", verify(view.root<table>(), 50));
+
+        bool exists = false;
+        try
+        {
+            shm_pool again(name.c_str(), 1 << 20);
+        }
+        catch (const std::system_error&)
+        {
+            exists = true;
+        }
+        check("create fails if it exists", exists);
+
+        shm_pool::unlink(name.c_str());
+    }
+
+    {
+        bool thrown = false;
+        try
+        {
+            shm_view view = shm_view::attach_fd(-1);
+        }
+        catch (const std::system_error&)
+        {
+            thrown = true;
+        }
+        check("bad descriptor", thrown);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+#include "btdef/allocator/basic_slab.hpp"
+#include "btdef/allocator/wrapper.hpp"
+
+#include <map>
+#include <list>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+static bool aligned(const void* p, std::size_t alignment)
+{
+    return p && !(reinterpret_cast<std::uintptr_t>(p) & (alignment - 1));
+}
+
+using btdef::allocator::slab;
+using btdef::allocator::wrapper;
+
+typedef std::list<int, wrapper<int, slab>> slab_list;
+typedef std::map<int, int, std::less<int>,
+    wrapper<std::pair<const int, int>, slab>> slab_map;
+
+// true if the slab capacity after the first run of fn never changes
+template<class F>
+static bool flat(slab& s, std::size_t count, F&& fn)
+{
+    fn();
+    const std::size_t first = s.capacity();
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        fn();
+        if (s.capacity() != first)
+            return false;
+    }
+    return first != 0;
+}
+
+int main()
+{
+    const int nodes = 10000;
+
+    {
+        // freed nodes go back to their class
+        slab s;
+        slab_list l{wrapper<int, slab>(s)};
+        const bool ok = flat(s, 100, [&] {
+            for (int i = 0; i < nodes; ++i)
+                l.push_back(i);
+            // every other one, then the rest
+            for (auto i = l.begin(); i != l.end(); )
+            {
+                i = l.erase(i);
+                if (i != l.end())
+                    ++i;
+            }
+            l.clear();
+        });
+        check("list capacity flat", ok);
+    }
+
+    {
+        slab s;
+        slab_map m{std::less<int>(),
+            wrapper<std::pair<const int, int>, slab>(s)};
+        const bool ok = flat(s, 100, [&] {
+            for (int i = 0; i < nodes; ++i)
+                m.emplace((i * 7919) % nodes, i);
+            for (int i = 0; i < nodes; i += 2)
+                m.erase(i);
+            m.clear();
+        });
+        check("map capacity flat", ok);
+    }
+
+    {
+        // malloc blocks of the large classes are not page aligned
+        slab s;
+        s.malloc(24);
+        void* a = s.malloc(2048);
+        void* b = s.malloc(4096);
+        check("malloc alignment", aligned(a, slab::block_alignment) &&
+            aligned(b, slab::block_alignment));
+
+        bool ok = true;
+        for (std::size_t alignment = 16; alignment <= 4096; alignment <<= 1)
+        {
+            void* p = s.aligned_malloc(100, alignment);
+            void* q = s.aligned_malloc(alignment, alignment);
+            void* r = s.aligned_malloc(5000, alignment);
+            ok = ok && aligned(p, alignment) && aligned(q, alignment) &&
+                aligned(r, alignment);
+        }
+        check("aligned_malloc alignment", ok);
+    }
+
+    {
+        // a misaligned free block of the class does not refill each time
+        slab s;
+        void* warm = s.aligned_malloc(4096, 4096);
+        s.free(warm, 4096, 4096);
+        std::size_t first = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            void* p = s.malloc(4096);
+            void* q = s.aligned_malloc(4096, 4096);
+            s.free(q, 4096, 4096);
+            s.free(p, 4096);
+            if (!i)
+                first = s.capacity();
+        }
+        check("mixed alignment capacity flat", s.capacity() == first);
+    }
+
+    {
+        // aligned_realloc keeps the alignment in a class and out of it
+        slab s;
+        char* p = static_cast<char*>(s.aligned_malloc(100, 256));
+        std::memset(p, 0x5a, 100);
+        p = static_cast<char*>(s.aligned_realloc(p, 100, 3000, 256));
+        const bool small = aligned(p, 256) && (p[99] == 0x5a);
+        p = static_cast<char*>(s.aligned_realloc(p, 3000, 10000, 256));
+        const bool large = aligned(p, 256) && (p[99] == 0x5a);
+        s.free(p, 10000, 256);
+        check("aligned_realloc", small && large);
+    }
+
+    const std::size_t count = 100;
+
+    test("std::list", count, [&](std::size_t) {
+        std::list<int> l;
+        for (int i = 0; i < nodes; ++i)
+            l.push_back(i);
+        return l.size();
+    });
+
+    slab s;
+    test("slab list", count, [&](std::size_t) {
+        slab_list l{wrapper<int, slab>(s)};
+        for (int i = 0; i < nodes; ++i)
+            l.push_back(i);
+        return l.size();
+    });
+
+    return failed ? 1 : 0;
+}
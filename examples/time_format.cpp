@@ -0,0 +1,64 @@
+#include "btdef/date.hpp"
+
+#include <ctime>
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::util::time_format;
+
+    const std::size_t count = 2000000;
+    const date::value_t base = date::now().time();
+    auto at = [&](std::size_t counter) {
+        return base + static_cast<date::value_t>(counter) * 997;
+    };
+
+    static const char pattern[] = "%a %b %d %Y %H:%M:%S GMT%z (%Z)";
+    static constexpr time_format fmt(pattern);
+
+    test("strftime", count, [&](std::size_t counter) {
+        const std::tm tms = date::local(date(at(counter))).data();
+        char buf[128];
+        return std::strftime(buf, sizeof(buf), pattern, &tms);
+    });
+
+    test("time_format", count, [&](std::size_t counter) {
+        const std::tm tms = date::local(date(at(counter))).data();
+        char buf[128];
+        return static_cast<std::size_t>(fmt.put(tms, buf, sizeof(buf)) - buf);
+    });
+
+    test("d.text()", count, [&](std::size_t counter) {
+        return date(at(counter)).text().size();
+    });
+
+    test("d.utc_text()", count, [&](std::size_t counter) {
+        return date(at(counter)).utc_text().size();
+    });
+
+    return 0;
+}
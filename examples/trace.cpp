@@ -0,0 +1,124 @@
+#include "btdef/allocator/trace.hpp"
+#include "btdef/allocator/wrapper.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <iostream>
+
+#if !BTDEF_ALLOCATOR_TRACE
+#error "build with -DBTDEF_ALLOCATOR_TRACE=1"
+#endif // BTDEF_ALLOCATOR_TRACE
+
+namespace trace = btdef::allocator::trace;
+
+static int failed = 0;
+
+static void check(const char* what, bool ok)
+{
+    std::cout << what << (ok ? " - ok" : " - FAIL") << std::endl;
+    if (!ok)
+        ++failed;
+}
+
+static bool same(const trace::counter& c, std::uint64_t count,
+    std::uint64_t bytes)
+{
+    return (c.count() == count) && (c.bytes() == bytes);
+}
+
+static std::string dump()
+{
+    std::string result;
+    std::FILE* f = std::tmpfile();
+    if (!f)
+        return result;
+
+    trace::dump(f);
+    std::rewind(f);
+    char buf[256];
+    while (std::fgets(buf, sizeof(buf), f))
+        result += buf;
+    std::fclose(f);
+    return result;
+}
+
+static bool has(const std::string& text, const char* line)
+{
+    return text.find(line) != std::string::npos;
+}
+
+int main()
+{
+    using btdef::allocator::pool;
+    using btdef::allocator::wrapper;
+
+    // chunk_header in front of every chunk
+    const std::size_t header = 3 * sizeof(std::size_t);
+
+    {
+        pool p(4096);
+        // 8 bytes and the first chunk
+        p.malloc(1);
+        p.malloc(100);
+        p.malloc(1000);
+
+        // not the last block, realloc copies 16 bytes
+        void* r = p.malloc(16);
+        p.malloc(8);
+        p.realloc(r, 16, 64);
+
+        // 10 ints under tag 3
+        std::vector<int, wrapper<int>> v(wrapper<int>(p, 3));
+        v.reserve(10);
+
+        // tags past the end go to the last one
+        wrapper<int>(p, 1000).allocate(1);
+
+        // does not fit the chunk, one of its own
+        p.malloc(5000);
+    }
+
+    // counters of a finished thread are kept
+    std::thread([] {
+        pool p;
+        p.malloc(32);
+    }).join();
+
+    trace::counters c;
+    trace::registry::instance().collect(c);
+
+    const std::uint64_t chunk_bytes = (header + 4096) + (header + 5000) +
+        (header + pool::chunk_capacity);
+
+    check("pool total", same(c.total_[trace::pool], 10,
+        8 + 104 + 1000 + 16 + 8 + 64 + 40 + 8 + 5000 + 32));
+    check("chunk total", same(c.total_[trace::chunk], 3, chunk_bytes));
+    check("system total", same(c.total_[trace::system], 3, chunk_bytes));
+
+    const trace::counter* h = c.histogram_[trace::pool];
+    check("pool histogram", same(h[3], 3, 8 + 8 + 8) &&
+        same(h[4], 1, 16) && same(h[5], 2, 40 + 32) &&
+        same(h[6], 2, 104 + 64) && same(h[9], 1, 1000) &&
+        same(h[12], 1, 5000));
+
+    h = c.histogram_[trace::chunk];
+    check("chunk histogram", same(h[12], 2, header * 2 + 4096 + 5000) &&
+        same(h[16], 1, header + pool::chunk_capacity));
+
+    check("tag", same(c.tag_[3], 1, 10 * sizeof(int)));
+    check("last tag", same(c.tag_[BTDEF_ALLOCATOR_TRACE_TAGS - 1], 1,
+        sizeof(int)));
+    check("realloc copy", same(c.realloc_copy_, 1, 16));
+
+    const std::string text = dump();
+    std::cout << text;
+    check("dump pool", has(text, "pool: count 10, bytes 6280\n"));
+    check("dump histogram", has(text, "  [2^3, 2^4): count 3, bytes 24\n"));
+    check("dump tag", has(text, "tag 3: count 1, bytes 40\n") &&
+        has(text, "tag 63: count 1, bytes 4\n"));
+    check("dump realloc copy", has(text, "realloc copy: count 1, bytes 16\n"));
+
+    return failed ? 1 : 0;
+}
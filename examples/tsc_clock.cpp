@@ -0,0 +1,58 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::time::tsc_clock;
+
+    tsc_clock::start();
+
+    const std::size_t count = 10000000;
+
+    test("time::steady()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(
+            btdef::time::steady().time_since_epoch().count() & 1);
+    });
+
+    test("tsc_clock::ticks()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(tsc_clock::ticks() & 1);
+    });
+
+    test("tsc_clock::now()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(
+            tsc_clock::now().time_since_epoch().count() & 1);
+    });
+
+    test("date::now<tsc_clock>()", count, [&](std::size_t) {
+        return static_cast<std::size_t>(date::now<tsc_clock>().time() & 1);
+    });
+
+    tsc_clock::stop();
+
+    return 0;
+}
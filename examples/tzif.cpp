@@ -0,0 +1,66 @@
+#include "btdef/date.hpp"
+
+#include <chrono>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+int main()
+{
+    using btdef::date;
+    using btdef::util::time::tzif;
+
+    const std::size_t count = 2000000;
+    // a stamp every 17 minutes over 60 years
+    const date::value_t base = date::now().time();
+    auto at = [&](std::size_t counter) {
+        return date(base - static_cast<date::value_t>(counter) * 1020000);
+    };
+    auto sum = [](const btdef::util::text& t) {
+        return static_cast<std::size_t>(t.data()[12] + t.data()[24]);
+    };
+
+    const tzif& zone = tzif::find("America/New_York");
+
+    test("localtime_r", count, [&](std::size_t counter) {
+        std::time_t t = at(counter).unix_time();
+        std::tm tms;
+        ::localtime_r(&t, &tms);
+        return static_cast<std::size_t>(tms.tm_hour);
+    });
+
+    test("zone.local_time()", count, [&](std::size_t counter) {
+        return static_cast<std::size_t>(
+            zone.local_time(at(counter).unix_time()).tm_hour);
+    });
+
+    test("d.local_in(zone).to_json()", count, [&](std::size_t counter) {
+        return sum(at(counter).local_in(zone).to_json());
+    });
+
+    test("d.local_json(zone)", count, [&](std::size_t counter) {
+        return sum(at(counter).local_json(zone));
+    });
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "btdef/date.hpp"
+
+#include <ctime>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+template <typename F>
+void test(const char* what, std::size_t count, F&& fn)
+{
+    std::size_t result = 0;
+    auto counter = count;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    while (counter--) result += fn(counter);
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    const auto msec =
+        std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+
+    std::cout << what << " (" << result << ")" << std::endl
+        << "total - " << msec.count() << " msec"
+        << ", one - " << nsec.count() / count << " nsec"
+        << std::endl;
+}
+
+using btdef::util::time::zone_cache;
+
+// every field of localtime_r
+static bool same(std::time_t t)
+{
+    std::tm a{};
+    ::localtime_r(&t, &a);
+    const std::tm b = zone_cache::local_time(t);
+
+    return (a.tm_year == b.tm_year) && (a.tm_mon == b.tm_mon) &&
+        (a.tm_mday == b.tm_mday) && (a.tm_hour == b.tm_hour) &&
+        (a.tm_min == b.tm_min) && (a.tm_sec == b.tm_sec) &&
+        (a.tm_wday == b.tm_wday) && (a.tm_yday == b.tm_yday) &&
+        (a.tm_isdst == b.tm_isdst) && (a.tm_gmtoff == b.tm_gmtoff) &&
+        a.tm_zone && b.tm_zone && !std::strcmp(a.tm_zone, b.tm_zone);
+}
+
+static void set_zone(const char* zone)
+{
+    ::setenv("TZ", zone, 1);
+    ::tzset();
+    zone_cache::invalidate();
+}
+
+// 2000-01-01 to 2031-01-01
+static const std::time_t from = 946684800;
+static const std::time_t to = 1924992000;
+
+// forward and backward walks, random times and clusters
+// around random points, the order moves the cached ranges
+static std::size_t compare(std::mt19937_64& gen)
+{
+    std::size_t bad = 0;
+    for (std::time_t t = from; t < to; t += 7919)
+        bad += !same(t);
+    for (std::time_t t = to; t > from; t -= 7919)
+        bad += !same(t);
+
+    std::uniform_int_distribution<std::time_t> any(from, to);
+    for (int i = 0; i < 100000; ++i)
+        bad += !same(any(gen));
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        const std::time_t c = any(gen);
+        for (int j = -25; j < 25; ++j)
+            bad += !same(c + j * 3600);
+    }
+
+    return bad;
+}
+
+int main()
+{
+    static const char* zones[] = {
+        "UTC",
+        "Europe/Berlin",
+        // negative DST in the tz database
+        "Europe/Dublin",
+        "America/New_York",
+        // half an hour DST
+        "Australia/Lord_Howe",
+        "Asia/Kolkata",
+        // standard offset changes in 2011 and 2014
+        "Europe/Moscow",
+        // DST until 2019
+        "America/Sao_Paulo"
+    };
+
+    std::mt19937_64 gen(1);
+    int failed = 0;
+    for (auto zone : zones)
+    {
+        set_zone(zone);
+        const std::size_t bad = compare(gen);
+        std::cout << zone << " - " << (bad ? "FAIL " : "ok");
+        if (bad)
+            std::cout << bad;
+        std::cout << std::endl;
+        failed += (bad != 0);
+    }
+
+    set_zone("Europe/Berlin");
+
+    const std::size_t count = 1000000;
+    std::vector<std::time_t> times(count);
+    std::uniform_int_distribution<std::time_t> any(from, to);
+    for (auto& t : times)
+        t = any(gen);
+
+    test("localtime_r random", count, [&](std::size_t i) {
+        std::tm tms;
+        ::localtime_r(&times[i], &tms);
+        return static_cast<std::size_t>(tms.tm_hour);
+    });
+
+    test("zone_cache random", count, [&](std::size_t i) {
+        return static_cast<std::size_t>(
+            zone_cache::local_time(times[i]).tm_hour);
+    });
+
+    test("zone_cache sequential", count, [&](std::size_t i) {
+        return static_cast<std::size_t>(zone_cache::local_time(
+            from + static_cast<std::time_t>(i) * 1000).tm_hour);
+    });
+
+    return failed ? 1 : 0;
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "btdef/config.hpp"
+#include "btdef/allocator/trace.hpp"
 
 #include <cstdlib>
 
@@ -21,8 +22,11 @@ struct basic
 
     pointer allocate(size_type size, pointer h = nullptr) const noexcept
     {
-        return (size) ?
-            static_cast<pointer>(std::realloc(h, size * sizeof(T))) : nullptr;
+        if (!size)
+            return nullptr;
+
+        BTDEF_ALLOCATOR_TRACE_ALLOCATE(system, size * sizeof(T));
+        return static_cast<pointer>(std::realloc(h, size * sizeof(T)));
     }
 
     void deallocate(pointer p, size_type) const noexcept
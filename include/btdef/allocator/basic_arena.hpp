@@ -0,0 +1,136 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  basic_pool for objects
+ *  make<T>(args...) constructs T in the pool, for types with
+ *  a non-trivial destructor it also records a destructor thunk
+ *  clear() and rewind() run the thunks in reverse order
+ */
+
+template<typename T>
+class basic_arena
+{
+    // placed right before the object
+    struct record
+    {
+        void (*destroy_)(record*) noexcept;
+        record *prev_;
+    };
+
+    basic_pool<T> pool_;
+    record *last_{nullptr};
+
+    basic_arena(const basic_arena&);
+    basic_arena& operator=(const basic_arena&);
+
+    template<class U>
+    static constexpr std::size_t offset() noexcept
+    {
+        return (sizeof(record) + alignof(U) - 1) & ~(alignof(U) - 1);
+    }
+
+    template<class U>
+    static void destroy_thunk(record* r) noexcept
+    {
+        reinterpret_cast<U*>(reinterpret_cast<char*>(r) + offset<U>())->~U();
+    }
+
+public:
+    explicit basic_arena(std::size_t chunk_size = basic_pool<T>::chunk_capacity,
+        T* allocator = nullptr) noexcept
+        : pool_(chunk_size, allocator)
+    {   }
+
+    ~basic_arena() noexcept
+    {
+        destroy();
+    }
+
+    // raw memory for wrapper and friends
+    basic_pool<T>& pool() noexcept
+    {
+        return pool_;
+    }
+
+    template<class U, class... Args>
+    U* make(Args&&... args)
+    {
+        if constexpr (std::is_trivially_destructible<U>::value)
+        {
+            void* ptr = pool_.aligned_malloc(sizeof(U), alignof(U));
+            if (!ptr)
+                throw std::bad_alloc();
+
+            return new (ptr) U(std::forward<Args>(args)...);
+        }
+        else
+        {
+            constexpr std::size_t alignment = (alignof(U) > alignof(record)) ?
+                alignof(U) : alignof(record);
+
+            char* ptr = static_cast<char*>(
+                pool_.aligned_malloc(offset<U>() + sizeof(U), alignment));
+            if (!ptr)
+                throw std::bad_alloc();
+
+            U* obj = new (ptr + offset<U>()) U(std::forward<Args>(args)...);
+            last_ = new (ptr) record{&destroy_thunk<U>, last_};
+            return obj;
+        }
+    }
+
+    // runs the recorded destructors, the memory stays in the pool
+    void destroy() noexcept
+    {
+        while (last_)
+        {
+            record* r = last_;
+            last_ = r->prev_;
+            r->destroy_(r);
+        }
+    }
+
+    void clear() noexcept
+    {
+        destroy();
+        pool_.clear();
+    }
+
+    // like clear() but keeps chunks, see basic_pool::reset
+    void rewind(std::size_t max_chunk = std::numeric_limits<std::size_t>::max(),
+        std::size_t max_capacity = std::numeric_limits<std::size_t>::max())
+        noexcept
+    {
+        destroy();
+        pool_.reset(max_chunk, max_capacity);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return pool_.capacity();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return pool_.size();
+    }
+};
+
+typedef basic_arena<basic<char>> arena;
+
+} // namespace allocator
+} // namespace btdef
@@ -2,6 +2,7 @@
 
 #include "btdef/allocator/basic.hpp"
 
+#include <limits>
 #include <cstring>
 #include <cassert>
 
@@ -17,6 +18,8 @@ class basic_pool
 {
 public:
     static const std::size_t chunk_capacity = std::size_t(64 * 1024);
+    // the largest alignment supported by aligned_malloc
+    static const std::size_t max_alignment = std::size_t(4096);
 
 private:
     struct chunk_header
@@ -28,6 +31,8 @@ private:
 
     std::size_t chunk_capacity_{};
     chunk_header *head_{nullptr};
+    // chunks retained by reset() for reuse
+    chunk_header *free_{nullptr};
     void *buffer_{nullptr};
     T* allocator_{nullptr};
     T* own_{nullptr};
@@ -67,11 +72,64 @@ public:
         while (head_ && (head_ != buffer_))
         {
             chunk_header* next = head_->next_;
-            allocator_->free(head_);
+            release(head_);
             head_ = next;
         }
         if (head_ && (head_ == buffer_))
             head_->size_ = 0;
+
+        while (free_)
+        {
+            chunk_header* next = free_->next_;
+            release(free_);
+            free_ = next;
+        }
+    }
+
+    // like clear() but keeps up to max_chunk chunks (the oldest first)
+    // not exceeding max_capacity bytes in total for the next allocations
+    // steady-state build/reset loops do not touch the allocator at all
+    void reset(std::size_t max_chunk = std::numeric_limits<std::size_t>::max(),
+        std::size_t max_capacity = std::numeric_limits<std::size_t>::max())
+        noexcept
+    {
+        chunk_header* buffer = nullptr;
+        while (head_)
+        {
+            chunk_header* next = head_->next_;
+            if (head_ == buffer_)
+            {
+                buffer = head_;
+                buffer->size_ = 0;
+            }
+            else
+            {
+                // newest chunk goes deepest
+                head_->next_ = free_;
+                free_ = head_;
+            }
+            head_ = next;
+        }
+        head_ = buffer;
+
+        chunk_header** c = &free_;
+        std::size_t capacity = 0;
+        while (*c)
+        {
+            chunk_header* chunk = *c;
+            if (max_chunk && (capacity + chunk->capacity_ <= max_capacity))
+            {
+                --max_chunk;
+                capacity += chunk->capacity_;
+                discard(allocator_, chunk, 0);
+                c = &chunk->next_;
+            }
+            else
+            {
+                *c = chunk->next_;
+                release(chunk);
+            }
+        }
     }
 
     std::size_t capacity() const noexcept
@@ -82,6 +140,15 @@ public:
         return capacity;
     }
 
+    // capacity of the chunks retained by reset()
+    std::size_t retained() const noexcept
+    {
+        std::size_t capacity = 0;
+        for (chunk_header* c = free_; c != 0; c = c->next_)
+            capacity += c->capacity_;
+        return capacity;
+    }
+
     std::size_t size() const noexcept
     {
         size_t size = 0;
@@ -96,11 +163,12 @@ public:
             return nullptr;
 
         size = BTDEF_ALLOCATOR_ALIGN(size);
+        BTDEF_ALLOCATOR_TRACE_ALLOCATE(pool, size);
 
         if (head_ == 0 || head_->size_ + size > head_->capacity_)
         {
-            std::size_t next_chunk_capacity = chunk_capacity > size ?
-                chunk_capacity : size;
+            std::size_t next_chunk_capacity = chunk_capacity_ > size ?
+                chunk_capacity_ : size;
             if (!add_chunk(next_chunk_capacity))
                 return nullptr;
         }
@@ -111,6 +179,40 @@ public:
         return buffer;
     }
 
+    // alignment is a power of two not greater than max_alignment
+    void* aligned_malloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        constexpr std::size_t align = BTDEF_ALLOCATOR_ALIGN(1);
+        if (alignment <= align)
+            return malloc(size);
+
+        if (!size || (alignment > max_alignment) ||
+            (alignment & (alignment - 1)))
+            return nullptr;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+        BTDEF_ALLOCATOR_TRACE_ALLOCATE(pool, size);
+
+        std::size_t padding = head_ ? align_padding(alignment) : 0;
+        if (head_ == 0 || head_->size_ + padding + size > head_->capacity_)
+        {
+            std::size_t capacity = size + alignment - align;
+            std::size_t next_chunk_capacity = chunk_capacity_ > capacity ?
+                chunk_capacity_ : capacity;
+            if (!add_chunk(next_chunk_capacity))
+                return nullptr;
+            padding = align_padding(alignment);
+        }
+
+        head_->size_ += padding;
+        void *buffer = reinterpret_cast<char *>(head_) +
+            BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) + head_->size_;
+        head_->size_ += size;
+        return buffer;
+    }
+
+    // for blocks of malloc, a moved block has the malloc alignment,
+    // aligned_malloc ones go to aligned_realloc
     void* realloc(void* ptr, std::size_t size, std::size_t new_size) noexcept
     {
         if (!ptr)
@@ -126,22 +228,15 @@ public:
         if (size >= new_size)
             return ptr;
 
-        if (ptr == reinterpret_cast<char *>(head_) +
-            BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) + head_->size_ - size)
-        {
-            std::size_t increment = static_cast<std::size_t>(new_size - size);
-            if (head_->size_ + increment <= head_->capacity_)
-            {
-                head_->size_ += increment;
-                return ptr;
-            }
-        }
+        if (expand(ptr, size, new_size))
+            return ptr;
 
         // Realloc process: allocate and copy memory,
         // do not free original buffer.
         void* new_buffer = malloc(new_size);
         if (new_buffer)
         {
+            BTDEF_ALLOCATOR_TRACE_REALLOC_COPY(size);
             if (size)
                 std::memcpy(new_buffer, ptr, size);
             return new_buffer;
@@ -150,19 +245,142 @@ public:
             return nullptr;
     }
 
+    // realloc for a block of aligned_malloc, a moved block keeps
+    // the alignment
+    void* aligned_realloc(void* ptr, std::size_t size, std::size_t new_size,
+        std::size_t alignment) noexcept
+    {
+        if (alignment <= BTDEF_ALLOCATOR_ALIGN(1))
+            return realloc(ptr, size, new_size);
+
+        if (!ptr)
+            return aligned_malloc(new_size, alignment);
+
+        if (new_size == 0)
+            return nullptr;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+        new_size = BTDEF_ALLOCATOR_ALIGN(new_size);
+
+        if (size >= new_size)
+            return ptr;
+
+        // in place the address stays aligned
+        if (expand(ptr, size, new_size))
+            return ptr;
+
+        void* new_buffer = aligned_malloc(new_size, alignment);
+        if (new_buffer)
+        {
+            BTDEF_ALLOCATOR_TRACE_REALLOC_COPY(size);
+            std::memcpy(new_buffer, ptr, size);
+        }
+        return new_buffer;
+    }
+
+    // grows the block in place if it is the last one in the head chunk
+    // never moves the block, false means the caller has to copy
+    bool expand(void* ptr, std::size_t size, std::size_t new_size) noexcept
+    {
+        if (!ptr || !head_)
+            return false;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+        new_size = BTDEF_ALLOCATOR_ALIGN(new_size);
+
+        if (size >= new_size)
+            return true;
+
+        if (ptr == reinterpret_cast<char *>(head_) +
+            BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) + head_->size_ - size)
+        {
+            std::size_t increment = static_cast<std::size_t>(new_size - size);
+            if (head_->size_ + increment <= head_->capacity_)
+            {
+                head_->size_ += increment;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     static void free(void*) noexcept
     {   }
 
+    static void free(void*, std::size_t) noexcept
+    {   }
+
+    static void free(void*, std::size_t, std::size_t) noexcept
+    {   }
+
 private:
 
+    // bytes to skip in the head chunk to reach the alignment
+    std::size_t align_padding(std::size_t alignment) const noexcept
+    {
+        std::size_t top = reinterpret_cast<std::size_t>(head_) +
+            BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) + head_->size_;
+        return (alignment - (top & (alignment - 1))) & (alignment - 1);
+    }
+
+    static std::size_t chunk_size(std::size_t capacity) noexcept
+    {
+        return BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) + capacity;
+    }
+
+    void release(chunk_header* chunk) noexcept
+    {
+        assert(allocator_);
+        allocator_->deallocate(reinterpret_cast<typename T::pointer>(chunk),
+            chunk_size(chunk->capacity_));
+    }
+
+    // allocators like mapped<T> may give the pages of a retained chunk
+    // back to the system, the chunk header stays in place
+    template<class A>
+    static auto discard(A* allocator, chunk_header* chunk, int)
+        noexcept -> decltype(allocator->discard(chunk, std::size_t()), void())
+    {
+        allocator->discard(reinterpret_cast<char*>(chunk) +
+            BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)), chunk->capacity_);
+    }
+
+    template<class A>
+    static void discard(A*, chunk_header*, long) noexcept
+    {   }
+
+    chunk_header* reuse_chunk(std::size_t capacity) noexcept
+    {
+        for (chunk_header** c = &free_; *c; c = &(*c)->next_)
+        {
+            chunk_header* chunk = *c;
+            if (chunk->capacity_ >= capacity)
+            {
+                *c = chunk->next_;
+                return chunk;
+            }
+        }
+        return nullptr;
+    }
+
     bool add_chunk(std::size_t capacity) noexcept
     {
+        chunk_header* chunk = reuse_chunk(capacity);
+        if (chunk)
+        {
+            chunk->size_ = 0;
+            chunk->next_ = head_;
+            head_ = chunk;
+            return true;
+        }
+
         if (!allocator_)
             own_ = allocator_ = new T();
 
-        chunk_header* chunk = reinterpret_cast<chunk_header*>(
-            allocator_->allocate(BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header))
-                                                                + capacity));
+        BTDEF_ALLOCATOR_TRACE_ALLOCATE(chunk, chunk_size(capacity));
+        chunk = reinterpret_cast<chunk_header*>(
+            allocator_->allocate(chunk_size(capacity)));
 
         if (chunk)
         {
@@ -0,0 +1,218 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic.hpp"
+
+#include <new>
+#include <atomic>
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  basic_pool for many threads filling one arena
+ *  malloc reserves space with fetch_add on the head chunk and installs
+ *  a new chunk with compare_exchange when the head is full,
+ *  clear() and destruction must not race with malloc
+ *  T::allocate and T::deallocate must be thread safe
+ */
+
+template<typename T>
+class basic_shared_pool
+{
+public:
+    static const std::size_t chunk_capacity = std::size_t(64 * 1024);
+
+private:
+    struct chunk_header
+    {
+        std::size_t capacity_;
+        // may run past capacity_ while threads race for a full chunk
+        std::atomic<std::size_t> size_;
+        chunk_header *next_;
+    };
+
+    enum { header_size = BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header)) };
+
+    std::size_t chunk_capacity_{};
+    std::atomic<chunk_header*> head_{nullptr};
+    // blocks too large for a regular chunk, kept away from head_
+    std::atomic<chunk_header*> large_{nullptr};
+    // a chunk left over from a lost install race
+    std::atomic<chunk_header*> spare_{nullptr};
+    T* own_{nullptr};
+    T* allocator_{nullptr};
+
+    basic_shared_pool(const basic_shared_pool&);
+    basic_shared_pool& operator=(const basic_shared_pool&);
+
+    static char* data(chunk_header* chunk) noexcept
+    {
+        return reinterpret_cast<char*>(chunk) + header_size;
+    }
+
+    chunk_header* create_chunk(std::size_t capacity) noexcept
+    {
+        chunk_header* chunk = reinterpret_cast<chunk_header*>(
+            allocator_->allocate(header_size + capacity));
+        if (chunk)
+        {
+            chunk->capacity_ = capacity;
+            new (&chunk->size_) std::atomic<std::size_t>(0);
+            chunk->next_ = nullptr;
+        }
+        return chunk;
+    }
+
+    void release(chunk_header* chunk) noexcept
+    {
+        allocator_->deallocate(reinterpret_cast<typename T::pointer>(chunk),
+            header_size + chunk->capacity_);
+    }
+
+    void release(std::atomic<chunk_header*>& list) noexcept
+    {
+        chunk_header* chunk = list.exchange(nullptr, std::memory_order_acquire);
+        while (chunk)
+        {
+            chunk_header* next = chunk->next_;
+            release(chunk);
+            chunk = next;
+        }
+    }
+
+    static std::size_t capacity(const std::atomic<chunk_header*>& list)
+        noexcept
+    {
+        std::size_t capacity = 0;
+        auto c = list.load(std::memory_order_acquire);
+        for ( ; c != nullptr; c = c->next_)
+            capacity += c->capacity_;
+        return capacity;
+    }
+
+    static std::size_t size(const std::atomic<chunk_header*>& list) noexcept
+    {
+        std::size_t size = 0;
+        auto c = list.load(std::memory_order_acquire);
+        for ( ; c != nullptr; c = c->next_)
+        {
+            std::size_t s = c->size_.load(std::memory_order_relaxed);
+            size += (s < c->capacity_) ? s : c->capacity_;
+        }
+        return size;
+    }
+
+    void* large_malloc(std::size_t size) noexcept
+    {
+        chunk_header* chunk = create_chunk(size);
+        if (!chunk)
+            return nullptr;
+
+        chunk->size_.store(size, std::memory_order_relaxed);
+        chunk->next_ = large_.load(std::memory_order_relaxed);
+        while (!large_.compare_exchange_weak(chunk->next_, chunk,
+            std::memory_order_release, std::memory_order_relaxed));
+
+        return data(chunk);
+    }
+
+public:
+    explicit basic_shared_pool(std::size_t chunk_size = chunk_capacity,
+        T* allocator = nullptr)
+        : chunk_capacity_(chunk_size)
+        , allocator_(allocator ? allocator : (own_ = new T()))
+    {   }
+
+    ~basic_shared_pool() noexcept
+    {
+        clear();
+        delete own_;
+    }
+
+    // single-threaded
+    void clear() noexcept
+    {
+        release(head_);
+        release(large_);
+        release(spare_);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return capacity(head_) + capacity(large_);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size(head_) + size(large_);
+    }
+
+    void* malloc(std::size_t size) noexcept
+    {
+        if (!size)
+            return nullptr;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+
+        // a half-chunk block would waste the rest of the head
+        if (size > chunk_capacity_ / 2)
+            return large_malloc(size);
+
+        chunk_header* head = head_.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (head)
+            {
+                std::size_t offset =
+                    head->size_.fetch_add(size, std::memory_order_relaxed);
+                if (offset + size <= head->capacity_)
+                    return data(head) + offset;
+
+                // the head has already been replaced
+                chunk_header* current = head_.load(std::memory_order_acquire);
+                if (current != head)
+                {
+                    head = current;
+                    continue;
+                }
+            }
+
+            chunk_header* chunk = spare_.exchange(nullptr,
+                std::memory_order_acquire);
+            if (!chunk)
+            {
+                chunk = create_chunk(chunk_capacity_);
+                if (!chunk)
+                    return nullptr;
+            }
+
+            chunk->size_.store(size, std::memory_order_relaxed);
+            chunk->next_ = head;
+            if (head_.compare_exchange_strong(head, chunk,
+                std::memory_order_acq_rel, std::memory_order_acquire))
+                return data(chunk);
+
+            // somebody else installed a fresh head, keep ours for later
+            chunk_header* empty = nullptr;
+            if (!spare_.compare_exchange_strong(empty, chunk,
+                std::memory_order_release, std::memory_order_relaxed))
+                release(chunk);
+        }
+    }
+
+    static void free(void*) noexcept
+    {   }
+
+    static void free(void*, std::size_t) noexcept
+    {   }
+};
+
+typedef basic_shared_pool<basic<char>> shared_pool;
+
+} // namespace allocator
+} // namespace btdef
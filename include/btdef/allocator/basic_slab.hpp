@@ -0,0 +1,371 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+namespace btdef {
+namespace allocator {
+namespace detail {
+
+constexpr std::size_t class_count(std::size_t min, std::size_t max) noexcept
+{
+    std::size_t count = 1;
+    for (std::size_t c = min; c < max; c <<= 1)
+        ++count;
+    return count;
+}
+
+} // namespace detail
+
+/*
+ *  size-class allocator on top of basic_pool
+ *  small blocks are rounded up to a power of two class and recycled
+ *  through per-class intrusive free lists, blocks above max_class
+ *  go straight to the chunk allocator and are released on free
+ *  blocks of a class are aligned to the class size up to block_alignment,
+ *  aligned_malloc with more than that looks for a free block with
+ *  that alignment and refills the class with aligned blocks if none
+ */
+
+template<typename T>
+class basic_slab
+{
+public:
+    static const std::size_t min_class = std::size_t(BTDEF_ALLOCATOR_ALIGN(1));
+    static const std::size_t max_class = std::size_t(4096);
+    // bytes carved from the pool at once for a single class
+    static const std::size_t batch_size = std::size_t(4096);
+    // a cache line, larger classes do not pad their batches further
+    static const std::size_t block_alignment = std::size_t(64);
+
+private:
+    struct free_block
+    {
+        free_block *next_;
+    };
+
+    // placed right before the block
+    struct large_header
+    {
+        large_header *prev_;
+        large_header *next_;
+        std::size_t size_;
+        // what the chunk allocator returned
+        void *base_;
+    };
+
+    enum { large_offset = BTDEF_ALLOCATOR_ALIGN(sizeof(large_header)) };
+
+    T* own_{nullptr};
+    T* allocator_{nullptr};
+    basic_pool<T> pool_;
+    free_block *free_[detail::class_count(min_class, max_class)]{};
+    large_header *large_{nullptr};
+
+    basic_slab(const basic_slab&);
+    basic_slab& operator=(const basic_slab&);
+
+    static std::size_t class_index(std::size_t size) noexcept
+    {
+        std::size_t index = 0;
+        for (std::size_t c = min_class; c < size; c <<= 1)
+            ++index;
+        return index;
+    }
+
+    void* large_malloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        constexpr std::size_t align = BTDEF_ALLOCATOR_ALIGN(1);
+        std::size_t padding = (alignment > align) ? alignment - align : 0;
+
+        std::size_t total = large_offset + padding + size;
+        char* base = reinterpret_cast<char*>(allocator_->allocate(total));
+        if (!base)
+            return nullptr;
+
+        char* ptr = base + large_offset;
+        if (padding)
+        {
+            ptr += (alignment - (reinterpret_cast<std::size_t>(ptr) &
+                (alignment - 1))) & (alignment - 1);
+        }
+
+        large_header* block = reinterpret_cast<large_header*>(
+            ptr - large_offset);
+        block->prev_ = nullptr;
+        block->next_ = large_;
+        block->size_ = total;
+        block->base_ = base;
+        if (large_)
+            large_->prev_ = block;
+        large_ = block;
+
+        return ptr;
+    }
+
+    void large_release(large_header* block) noexcept
+    {
+        allocator_->deallocate(
+            reinterpret_cast<typename T::pointer>(block->base_), block->size_);
+    }
+
+    void large_free(void* ptr) noexcept
+    {
+        large_header* block = reinterpret_cast<large_header*>(
+            static_cast<char*>(ptr) - large_offset);
+
+        if (block->prev_)
+            block->prev_->next_ = block->next_;
+        else
+            large_ = block->next_;
+        if (block->next_)
+            block->next_->prev_ = block->prev_;
+
+        large_release(block);
+    }
+
+    // the new blocks go first in the list, aligned to the class size
+    // up to block_alignment or to alignment if that is more
+    bool refill(std::size_t index, std::size_t alignment) noexcept
+    {
+        std::size_t size = min_class << index;
+        std::size_t count = (batch_size > size) ? batch_size / size : 1;
+
+        std::size_t natural = (size < block_alignment) ?
+            size : block_alignment;
+        if (alignment < natural)
+            alignment = natural;
+
+        char* batch = static_cast<char*>(
+            pool_.aligned_malloc(count * size, alignment));
+        if (!batch)
+            return false;
+
+        free_block* head = free_[index];
+        for (std::size_t i = count; i-- > 0; )
+        {
+            free_block* block = reinterpret_cast<free_block*>(batch + i * size);
+            block->next_ = head;
+            head = block;
+        }
+        free_[index] = head;
+
+        return true;
+    }
+
+public:
+    explicit basic_slab(std::size_t chunk_size = basic_pool<T>::chunk_capacity,
+        T* allocator = nullptr)
+        : allocator_(allocator ? allocator : (own_ = new T()))
+        , pool_(chunk_size, allocator_)
+    {   }
+
+    ~basic_slab() noexcept
+    {
+        clear();
+        delete own_;
+    }
+
+    // releases every block at once, including large ones
+    void clear() noexcept
+    {
+        release();
+        pool_.clear();
+    }
+
+    // like clear() but keeps pool chunks for reuse, see basic_pool::reset
+    void reset(std::size_t max_chunk = std::numeric_limits<std::size_t>::max(),
+        std::size_t max_capacity = std::numeric_limits<std::size_t>::max())
+        noexcept
+    {
+        release();
+        pool_.reset(max_chunk, max_capacity);
+    }
+
+    // bytes held in pool chunks
+    std::size_t capacity() const noexcept
+    {
+        return pool_.capacity();
+    }
+
+    void* malloc(std::size_t size) noexcept
+    {
+        if (!size)
+            return nullptr;
+
+        if (size > max_class)
+            return large_malloc(size, 0);
+
+        return class_malloc(class_index(size));
+    }
+
+    // alignment is a power of two not greater than basic_pool::max_alignment
+    // the block must be freed with the same size and alignment
+    void* aligned_malloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        if (!size || (alignment > basic_pool<T>::max_alignment) ||
+            (alignment & (alignment - 1)))
+            return nullptr;
+
+        std::size_t class_size = (size < alignment) ? alignment : size;
+        if (class_size > max_class)
+            return large_malloc(size, alignment);
+
+        std::size_t index = class_index(class_size);
+        if (alignment > block_alignment)
+            return aligned_class_malloc(index, alignment);
+
+        return class_malloc(index);
+    }
+
+    // for blocks of malloc, aligned_malloc ones go to aligned_realloc
+    void* realloc(void* ptr, std::size_t size, std::size_t new_size) noexcept
+    {
+        if (!ptr)
+            return malloc(new_size);
+
+        if (new_size == 0)
+        {
+            free(ptr, size);
+            return nullptr;
+        }
+
+        if ((size <= max_class) && (new_size <= max_class) &&
+            (class_index(size) == class_index(new_size)))
+            return ptr;
+
+        void* new_buffer = malloc(new_size);
+        if (new_buffer)
+        {
+            BTDEF_ALLOCATOR_TRACE_REALLOC_COPY((size < new_size) ?
+                size : new_size);
+            std::memcpy(new_buffer, ptr, (size < new_size) ? size : new_size);
+            free(ptr, size);
+        }
+        return new_buffer;
+    }
+
+    // the same for a block of aligned_malloc, the new block keeps
+    // the alignment
+    void* aligned_realloc(void* ptr, std::size_t size, std::size_t new_size,
+        std::size_t alignment) noexcept
+    {
+        if (!ptr)
+            return aligned_malloc(new_size, alignment);
+
+        if (new_size == 0)
+        {
+            free(ptr, size, alignment);
+            return nullptr;
+        }
+
+        std::size_t from = (size < alignment) ? alignment : size;
+        std::size_t to = (new_size < alignment) ? alignment : new_size;
+        if ((from <= max_class) && (to <= max_class) &&
+            (class_index(from) == class_index(to)))
+            return ptr;
+
+        void* new_buffer = aligned_malloc(new_size, alignment);
+        if (new_buffer)
+        {
+            BTDEF_ALLOCATOR_TRACE_REALLOC_COPY((size < new_size) ?
+                size : new_size);
+            std::memcpy(new_buffer, ptr, (size < new_size) ? size : new_size);
+            free(ptr, size, alignment);
+        }
+        return new_buffer;
+    }
+
+    // true if the new size still maps to the block's class,
+    // free(ptr, new_size) has to find the same list, shrinking too
+    bool expand(void* ptr, std::size_t size, std::size_t new_size)
+        const noexcept
+    {
+        if (!ptr || !size || !new_size)
+            return false;
+
+        // large blocks are freed by address, they only shrink
+        if (size > max_class)
+            return (new_size <= size) && (new_size > max_class);
+
+        return (new_size <= max_class) &&
+            (class_index(size) == class_index(new_size));
+    }
+
+    // size must be the one passed to malloc
+    void free(void* ptr, std::size_t size) noexcept
+    {
+        if (!ptr || !size)
+            return;
+
+        if (size > max_class)
+            large_free(ptr);
+        else
+            class_free(ptr, class_index(size));
+    }
+
+    void free(void* ptr, std::size_t size, std::size_t alignment) noexcept
+    {
+        free(ptr, (size < alignment) ? alignment : size);
+    }
+
+private:
+    void* class_malloc(std::size_t index) noexcept
+    {
+        if (!free_[index] && !refill(index, 0))
+            return nullptr;
+
+        free_block* block = free_[index];
+        free_[index] = block->next_;
+        return block;
+    }
+
+    // the first free block of the class with that alignment
+    void* aligned_class_malloc(std::size_t index,
+        std::size_t alignment) noexcept
+    {
+        for (free_block** b = &free_[index]; *b; b = &(*b)->next_)
+        {
+            if (!(reinterpret_cast<std::size_t>(*b) & (alignment - 1)))
+            {
+                free_block* block = *b;
+                *b = block->next_;
+                return block;
+            }
+        }
+
+        if (!refill(index, alignment))
+            return nullptr;
+
+        return class_malloc(index);
+    }
+
+    void class_free(void* ptr, std::size_t index) noexcept
+    {
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next_ = free_[index];
+        free_[index] = block;
+    }
+
+    void release() noexcept
+    {
+        while (large_)
+        {
+            large_header* next = large_->next_;
+            large_release(large_);
+            large_ = next;
+        }
+
+        for (auto& head : free_)
+            head = nullptr;
+    }
+};
+
+typedef basic_slab<basic<char>> slab;
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,434 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/offset_ptr.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <cassert>
+#include <cstdint>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  basic_pool whose chunks live in a memory mapped file
+ *  the file is mapped at one place inside a reserved address range,
+ *  so objects linked with offset_ptr survive a restart as they are:
+ *
+ *  file_pool pool("/var/cache/ref.pool");
+ *  auto table = pool.root<table_t>();
+ *  if (!table) { table = build(pool); pool.set_root(table); pool.sync(); }
+ *
+ *  sync() is the checkpoint: after a crash the chunk layout and the root
+ *  come back as of the last sync(), allocations made later are dropped
+ *  (contents of already allocated blocks are not rolled back)
+ *
+ *  the file is locked with flock, a second file_pool on it fails
+ *  with EWOULDBLOCK; a header that does not fit the file fails with EINVAL
+ */
+
+class file_pool
+{
+public:
+    static const std::size_t chunk_capacity = std::size_t(1024 * 1024);
+    // address space reserved for the file
+    static const std::size_t max_capacity = std::size_t(1024 * 1024 * 1024);
+
+private:
+    struct chunk_header
+    {
+        std::uint64_t capacity_;
+        std::uint64_t size_;
+        // file offset of the previous chunk, 0 for none
+        std::uint64_t next_;
+    };
+
+    struct file_header
+    {
+        char magic_[8];
+        std::uint32_t version_;
+        std::uint32_t header_size_;
+        std::uint64_t length_;
+        std::uint64_t head_;
+        std::uint64_t root_;
+        // state as of the last sync
+        std::uint64_t sync_length_;
+        std::uint64_t sync_head_;
+        std::uint64_t sync_head_size_;
+        std::uint64_t sync_root_;
+    };
+
+    enum {
+        version = 1,
+        header_size = BTDEF_ALLOCATOR_ALIGN(sizeof(chunk_header))
+    };
+
+    int fd_{-1};
+    char* base_{nullptr};
+    std::size_t reserved_{};
+    std::size_t page_{};
+    std::size_t chunk_capacity_{};
+    bool created_{false};
+
+    file_pool(const file_pool&);
+    file_pool& operator=(const file_pool&);
+
+    static const char* magic() noexcept
+    {
+        return "btdefpl";
+    }
+
+    [[noreturn]] static void raise(const char* what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    file_header& header() const noexcept
+    {
+        return *reinterpret_cast<file_header*>(base_);
+    }
+
+    chunk_header* chunk(std::uint64_t offset) const noexcept
+    {
+        return offset ? reinterpret_cast<chunk_header*>(base_ + offset) :
+            nullptr;
+    }
+
+    std::size_t round_page(std::size_t size) const noexcept
+    {
+        return (size + page_ - 1) & ~(page_ - 1);
+    }
+
+    // maps [from, to) of the file into the reserved range
+    bool map(std::size_t from, std::size_t to) noexcept
+    {
+        if (from == to)
+            return true;
+
+        void* ptr = ::mmap(base_ + from, to - from, PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_FIXED, fd_, static_cast<off_t>(from));
+        return ptr != MAP_FAILED;
+    }
+
+    bool add_chunk(std::size_t capacity) noexcept
+    {
+        file_header& h = header();
+        std::size_t offset = static_cast<std::size_t>(h.length_);
+        std::size_t length = offset + round_page(header_size + capacity);
+        if (length > reserved_)
+            return false;
+
+        if (::ftruncate(fd_, static_cast<off_t>(length)) != 0)
+            return false;
+
+        if (!map(offset, length))
+            return false;
+
+        chunk_header* c = chunk(offset);
+        c->capacity_ = length - offset - header_size;
+        c->size_ = 0;
+        c->next_ = h.head_;
+        h.head_ = offset;
+        h.length_ = length;
+
+        return true;
+    }
+
+    void create()
+    {
+        std::size_t length = round_page(sizeof(file_header));
+        if (::ftruncate(fd_, static_cast<off_t>(length)) != 0)
+            raise("ftruncate");
+
+        if (!map(0, length))
+            raise("mmap");
+
+        file_header& h = header();
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic_, magic(), sizeof(h.magic_));
+        h.version_ = version;
+        h.header_size_ = sizeof(file_header);
+        h.length_ = length;
+        h.sync_length_ = length;
+        created_ = true;
+    }
+
+    // the checkpoint has to fit the file and the reserved range
+    bool valid(const file_header& h, std::size_t length) const noexcept
+    {
+        const std::uint64_t sync_length = h.sync_length_;
+        if ((sync_length < page_) || (sync_length > length) ||
+            (sync_length > reserved_) || (sync_length & (page_ - 1)))
+            return false;
+
+        // the head chunk is a page aligned offset
+        if (h.sync_head_ && ((h.sync_head_ < page_) ||
+            (h.sync_head_ & (page_ - 1)) ||
+            (h.sync_head_ + header_size > sync_length) ||
+            (h.sync_head_size_ > sync_length - h.sync_head_ - header_size)))
+            return false;
+
+        if (!h.sync_head_ && h.sync_head_size_)
+            return false;
+
+        return !h.sync_root_ ||
+            ((h.sync_root_ >= page_) && (h.sync_root_ < sync_length));
+    }
+
+    void open(std::size_t length)
+    {
+        if (length > reserved_)
+        {
+            errno = EFBIG;
+            raise("file_pool");
+        }
+
+        if (length < page_)
+        {
+            errno = EINVAL;
+            raise("file_pool");
+        }
+
+        if (!map(0, page_))
+            raise("mmap");
+
+        file_header& h = header();
+        if (std::memcmp(h.magic_, magic(), sizeof(h.magic_)) ||
+            (h.version_ != version) ||
+            (h.header_size_ != sizeof(file_header)) || !valid(h, length))
+        {
+            errno = EINVAL;
+            raise("file_pool");
+        }
+
+        // the checkpoint is inside the file, map it before truncating
+        length = static_cast<std::size_t>(h.sync_length_);
+        if (!map(page_, length))
+            raise("mmap");
+
+        chunk_header* head = chunk(h.sync_head_);
+        if (head && ((h.sync_head_size_ > head->capacity_) ||
+            (head->capacity_ > length - h.sync_head_ - header_size)))
+        {
+            errno = EINVAL;
+            raise("file_pool");
+        }
+
+        // back to the last checkpoint
+        if (::ftruncate(fd_, static_cast<off_t>(length)) != 0)
+            raise("ftruncate");
+
+        h.length_ = h.sync_length_;
+        h.head_ = h.sync_head_;
+        h.root_ = h.sync_root_;
+        if (head)
+            head->size_ = h.sync_head_size_;
+    }
+
+    void close() noexcept
+    {
+        if (base_)
+            ::munmap(base_, reserved_);
+        if (fd_ >= 0)
+            ::close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+    }
+
+public:
+    explicit file_pool(const char* path,
+        std::size_t chunk_size = chunk_capacity,
+        std::size_t reserve = max_capacity)
+        : page_(static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)))
+        , chunk_capacity_(chunk_size)
+    {
+        assert(path);
+
+        reserved_ = round_page(reserve);
+
+        fd_ = ::open(path, O_RDWR|O_CREAT|O_CLOEXEC, 0644);
+        if (fd_ < 0)
+            raise("open");
+
+        void* ptr = ::mmap(nullptr, reserved_, PROT_NONE,
+            MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+        if (ptr == MAP_FAILED)
+        {
+            int code = errno;
+            close();
+            errno = code;
+            raise("mmap");
+        }
+        base_ = static_cast<char*>(ptr);
+
+        try
+        {
+            // one process at a time
+            if (::flock(fd_, LOCK_EX|LOCK_NB) != 0)
+                raise("flock");
+
+            struct stat st;
+            if (::fstat(fd_, &st) != 0)
+                raise("fstat");
+
+            if (st.st_size == 0)
+                create();
+            else
+                open(static_cast<std::size_t>(st.st_size));
+        }
+        catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    ~file_pool() noexcept
+    {
+        close();
+    }
+
+    // the file was empty and has just been initialized
+    bool created() const noexcept
+    {
+        return created_;
+    }
+
+    // checkpoint, flushes the data and then the header
+    bool sync() noexcept
+    {
+        file_header& h = header();
+        if (::msync(base_, static_cast<std::size_t>(h.length_), MS_SYNC) != 0)
+            return false;
+
+        h.sync_length_ = h.length_;
+        h.sync_head_ = h.head_;
+        h.sync_head_size_ = h.head_ ? chunk(h.head_)->size_ : 0;
+        h.sync_root_ = h.root_;
+
+        return ::msync(base_, page_, MS_SYNC) == 0;
+    }
+
+    template<class T>
+    T* root() const noexcept
+    {
+        return static_cast<T*>(at(header().root_));
+    }
+
+    void set_root(const void* ptr) noexcept
+    {
+        header().root_ = offset(ptr);
+    }
+
+    // file offset of a pointer into the pool, 0 for nullptr
+    std::uint64_t offset(const void* ptr) const noexcept
+    {
+        return ptr ? static_cast<std::uint64_t>(
+            static_cast<const char*>(ptr) - base_) : 0;
+    }
+
+    void* at(std::uint64_t offset) const noexcept
+    {
+        return offset ? base_ + offset : nullptr;
+    }
+
+    // drops everything and checkpoints, the file shrinks to the header
+    bool clear() noexcept
+    {
+        file_header& h = header();
+        std::size_t length = round_page(sizeof(file_header));
+        ::mmap(base_ + length, reserved_ - length, PROT_NONE,
+            MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE|MAP_FIXED, -1, 0);
+        h.length_ = length;
+        h.head_ = 0;
+        h.root_ = 0;
+
+        return sync() && (::ftruncate(fd_, static_cast<off_t>(length)) == 0);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        std::size_t capacity = 0;
+        for (chunk_header* c = chunk(header().head_); c; c = chunk(c->next_))
+            capacity += static_cast<std::size_t>(c->capacity_);
+        return capacity;
+    }
+
+    std::size_t size() const noexcept
+    {
+        std::size_t size = 0;
+        for (chunk_header* c = chunk(header().head_); c; c = chunk(c->next_))
+            size += static_cast<std::size_t>(c->size_);
+        return size;
+    }
+
+    void* malloc(std::size_t size) noexcept
+    {
+        return aligned_malloc(size, BTDEF_ALLOCATOR_ALIGN(1));
+    }
+
+    // alignment is a power of two not greater than the page size
+    void* aligned_malloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        if (!size || (alignment > page_) || (alignment & (alignment - 1)))
+            return nullptr;
+
+        constexpr std::size_t align = BTDEF_ALLOCATOR_ALIGN(1);
+        if (alignment < align)
+            alignment = align;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+
+        // chunk data starts page aligned + header_size
+        chunk_header* head = chunk(header().head_);
+        std::size_t padding = 0;
+        if (head)
+        {
+            std::size_t top = header_size + static_cast<std::size_t>(
+                head->size_);
+            padding = (alignment - (top & (alignment - 1))) & (alignment - 1);
+        }
+
+        if (!head || (head->size_ + padding + size > head->capacity_))
+        {
+            std::size_t capacity = size + alignment;
+            if (!add_chunk(chunk_capacity_ > capacity ?
+                chunk_capacity_ : capacity))
+                return nullptr;
+
+            head = chunk(header().head_);
+            padding = (alignment - (header_size & (alignment - 1))) &
+                (alignment - 1);
+        }
+
+        head->size_ += padding;
+        char* ptr = reinterpret_cast<char*>(head) + header_size +
+            static_cast<std::size_t>(head->size_);
+        head->size_ += size;
+        return ptr;
+    }
+
+    static void free(void*) noexcept
+    {   }
+
+    static void free(void*, std::size_t) noexcept
+    {   }
+
+    static void free(void*, std::size_t, std::size_t) noexcept
+    {   }
+};
+
+} // namespace allocator
+} // namespace btdef
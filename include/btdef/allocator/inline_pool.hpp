@@ -0,0 +1,50 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <cstddef>
+
+namespace btdef {
+namespace allocator {
+namespace detail {
+
+// goes first, so it exists before basic_pool writes its chunk header
+template<std::size_t N>
+struct inline_buffer
+{
+    alignas(std::max_align_t) char data_[N];
+};
+
+} // namespace detail
+
+/*
+ *  basic_pool with the first chunk inside the object
+ *  inline_pool<1024> workspace; on the stack never touches the heap
+ *  until the first N bytes are used up
+ */
+
+template<std::size_t N, class T = basic<char>>
+class basic_inline_pool
+    : detail::inline_buffer<N>
+    , public basic_pool<T>
+{
+public:
+    static const std::size_t inline_size = N;
+
+    explicit basic_inline_pool(
+        std::size_t chunk_size = basic_pool<T>::chunk_capacity,
+        T* allocator = nullptr) noexcept
+        : basic_pool<T>(this->data_, N, chunk_size, allocator)
+    {   }
+};
+
+template<std::size_t N>
+using inline_pool = basic_inline_pool<N, basic<char>>;
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,213 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/config.hpp"
+
+#include <cstdio>
+#include <cstddef>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  chunk allocator for basic_pool backed by anonymous memory mappings
+ *  basic_pool<mapped<char>> pool(mapped<char>::huge_page_size() - 64,
+ *      &alloc);
+ *  chunk sizes are rounded up to the page (or huge page) size,
+ *  so pick the pool chunk size close to that granularity
+ *
+ *  pages stay mapped across basic_pool::reset() unless release is set,
+ *  a chunk kept by reset() is then faulted in again on the next cycle
+ */
+
+template<class T>
+class mapped
+{
+public:
+    typedef T* pointer;
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    enum : int {
+        // explicit huge pages (MAP_HUGETLB), falls back to regular pages
+        huge_tlb = 0x01,
+        // transparent huge pages (MADV_HUGEPAGE)
+        huge_transparent = 0x02,
+        // prefault chunk pages (MAP_POPULATE)
+        populate = 0x04,
+        // return chunk pages to the kernel on basic_pool::reset()
+        // costs a page fault per page on the next use, off by default
+        release = 0x08
+    };
+
+    // the default huge page size of the system, 2 MB if unknown
+    static std::size_t huge_page_size() noexcept
+    {
+        static const std::size_t size = read_huge_page_size();
+        return size;
+    }
+
+private:
+    int flags_{huge_transparent};
+
+    static std::size_t read_huge_page_size() noexcept
+    {
+        std::size_t size = 0;
+#if defined(WIN32) || defined(_WIN32)
+        size = static_cast<std::size_t>(::GetLargePageMinimum());
+#else
+        // MAP_HUGETLB takes pages of this size
+        std::FILE* f = std::fopen("/proc/meminfo", "r");
+        if (f)
+        {
+            char line[128];
+            unsigned long kb = 0;
+            while (std::fgets(line, sizeof(line), f))
+            {
+                if (std::sscanf(line, "Hugepagesize: %lu kB", &kb) == 1)
+                {
+                    size = static_cast<std::size_t>(kb) * 1024;
+                    break;
+                }
+            }
+            std::fclose(f);
+        }
+#endif
+        // a power of two or nothing
+        if (!size || (size & (size - 1)))
+            size = std::size_t(2 * 1024 * 1024);
+        return size;
+    }
+
+    static std::size_t page_size() noexcept
+    {
+#if defined(WIN32) || defined(_WIN32)
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwPageSize);
+#else
+        static const std::size_t size =
+            static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+#endif
+    }
+
+    static std::size_t round_up(std::size_t size, std::size_t align) noexcept
+    {
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    // a huge_tlb chunk may have fallen back to regular pages,
+    // the huge page size is a multiple of both
+    std::size_t granularity() const noexcept
+    {
+        return (flags_ & huge_tlb) ? huge_page_size() : page_size();
+    }
+
+    std::size_t mapping_size(size_type size) const noexcept
+    {
+        return round_up(size * sizeof(T), granularity());
+    }
+
+public:
+    mapped() = default;
+
+    explicit mapped(int flags) noexcept
+        : flags_(flags)
+    {   }
+
+    int flags() const noexcept
+    {
+        return flags_;
+    }
+
+    pointer allocate(size_type size) const noexcept
+    {
+        if (!size)
+            return nullptr;
+
+        std::size_t len = mapping_size(size);
+#if defined(WIN32) || defined(_WIN32)
+        return static_cast<pointer>(::VirtualAlloc(nullptr, len,
+            MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE));
+#else
+        int map_flags = MAP_PRIVATE|MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+        if (flags_ & populate)
+            map_flags |= MAP_POPULATE;
+#endif // MAP_POPULATE
+
+        void* ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        // no reserved huge pages is a common case
+        if (flags_ & huge_tlb)
+            ptr = ::mmap(nullptr, len, PROT_READ|PROT_WRITE,
+                map_flags|MAP_HUGETLB, -1, 0);
+#endif // MAP_HUGETLB
+
+        if (ptr == MAP_FAILED)
+        {
+            ptr = ::mmap(nullptr, len, PROT_READ|PROT_WRITE, map_flags, -1, 0);
+            if (ptr == MAP_FAILED)
+                return nullptr;
+#ifdef MADV_HUGEPAGE
+            if (flags_ & (huge_tlb|huge_transparent))
+                ::madvise(ptr, len, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+        }
+
+        return static_cast<pointer>(ptr);
+#endif
+    }
+
+    void deallocate(pointer p, size_type size) const noexcept
+    {
+        if (p)
+        {
+#if defined(WIN32) || defined(_WIN32)
+            (void)size;
+            ::VirtualFree(p, 0, MEM_RELEASE);
+#else
+            ::munmap(p, mapping_size(size));
+#endif
+        }
+    }
+
+    // drop the physical pages of [p, p + size), the mapping stays valid
+    // only whole pages inside the range are discarded,
+    // whole huge pages for huge_tlb: the chunk header keeps its first
+    // huge page, so a chunk of a single huge page is never released
+    void discard(void* p, std::size_t size) const noexcept
+    {
+        if (!(flags_ & release))
+            return;
+
+        std::size_t page = granularity();
+        std::size_t from = round_up(reinterpret_cast<std::size_t>(p), page);
+        std::size_t to = (reinterpret_cast<std::size_t>(p) + size) &
+            ~(page - 1);
+        if (from < to)
+        {
+#if defined(WIN32) || defined(_WIN32)
+            ::VirtualAlloc(reinterpret_cast<void*>(from), to - from,
+                MEM_RESET, PAGE_READWRITE);
+#else
+            ::madvise(reinterpret_cast<void*>(from), to - from, MADV_DONTNEED);
+#endif
+        }
+    }
+};
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,253 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_shared_pool.hpp"
+
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include <cassert>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  chunk allocator placing chunks on a NUMA node
+ *  memory is bound with mbind before the first touch,
+ *  node = -1 means the node of the thread calling allocate
+ *  talks to the kernel directly, no libnuma needed
+ *  strict allocations fail (nullptr) if the memory cannot be bound,
+ *  for example to a node that does not exist or is not allowed
+ *  on single node machines (or not on linux) it is plain malloc
+ */
+
+template<class T>
+class numa
+{
+public:
+    typedef T* pointer;
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+private:
+    int node_{-1};
+    // MPOL_BIND instead of MPOL_PREFERRED
+    bool strict_{false};
+
+#if defined(__linux__)
+    enum {
+        mpol_preferred = 1,
+        mpol_bind = 2,
+        mpol_f_mems_allowed = 4,
+        max_node = 1024
+    };
+
+    typedef unsigned long mask_t;
+    enum { mask_bits = sizeof(mask_t) * 8 };
+
+    static std::size_t mapping_size(size_type size) noexcept
+    {
+        static const std::size_t page =
+            static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return (size * sizeof(T) + page - 1) & ~(page - 1);
+    }
+
+    static int allowed_node_count() noexcept
+    {
+        mask_t mask[max_node / mask_bits] = {};
+        if (::syscall(SYS_get_mempolicy, nullptr, mask,
+            static_cast<unsigned long>(max_node), nullptr,
+            static_cast<unsigned long>(mpol_f_mems_allowed)) != 0)
+            return 1;
+
+        int count = 1;
+        for (int n = 0; n < max_node; ++n)
+        {
+            if (mask[n / mask_bits] & (mask_t(1) << (n % mask_bits)))
+                count = n + 1;
+        }
+        return count;
+    }
+#endif // __linux__
+
+public:
+    numa() = default;
+
+    explicit numa(int node, bool strict = false) noexcept
+        : node_(node)
+        , strict_(strict)
+    {   }
+
+    int node() const noexcept
+    {
+        return node_;
+    }
+
+    // highest allowed node + 1
+    static int node_count() noexcept
+    {
+#if defined(__linux__)
+        static const int count = allowed_node_count();
+        return count;
+#else
+        return 1;
+#endif // __linux__
+    }
+
+    // node of the calling thread, 0 if unknown
+    static int current_node() noexcept
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        if (node_count() > 1)
+        {
+            unsigned cpu = 0;
+            unsigned node = 0;
+            if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+                return static_cast<int>(node);
+        }
+#endif
+        return 0;
+    }
+
+    pointer allocate(size_type size) const noexcept
+    {
+        if (!size)
+            return nullptr;
+
+#if defined(__linux__)
+        if (node_count() > 1)
+        {
+            std::size_t len = mapping_size(size);
+            void* ptr = ::mmap(nullptr, len, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+                return nullptr;
+
+            int node = (node_ < 0) ? current_node() : node_;
+            bool bound = false;
+            if (node < max_node)
+            {
+                mask_t mask[max_node / mask_bits] = {};
+                mask[node / mask_bits] = mask_t(1) << (node % mask_bits);
+                bound = ::syscall(SYS_mbind, ptr,
+                    static_cast<unsigned long>(len),
+                    strict_ ? mpol_bind : mpol_preferred, mask,
+                    static_cast<unsigned long>(max_node), 0u) == 0;
+            }
+
+            // preferred placement is a hint, the memory is usable anyway
+            // strict is not, no chunk rather than one on another node
+            if (!bound && strict_)
+            {
+                ::munmap(ptr, len);
+                return nullptr;
+            }
+
+            return static_cast<pointer>(ptr);
+        }
+#endif // __linux__
+        return static_cast<pointer>(std::malloc(size * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type size) const noexcept
+    {
+        if (!p)
+            return;
+
+#if defined(__linux__)
+        if (node_count() > 1)
+        {
+            ::munmap(p, mapping_size(size));
+            return;
+        }
+#else
+        (void)size;
+#endif // __linux__
+        std::free(p);
+    }
+};
+
+/*
+ *  arena per NUMA node, threads allocate from the arena of their node
+ *  P - pool type constructible from (chunk_size, numa<char>*),
+ *  shared between the threads of one node so it has to be thread safe
+ */
+
+template<class P>
+class basic_numa_arena
+{
+public:
+    using pool_type = P;
+
+private:
+    std::vector<std::unique_ptr<numa<char>>> allocator_{};
+    std::vector<std::unique_ptr<pool_type>> pool_{};
+
+    basic_numa_arena(const basic_numa_arena&);
+    basic_numa_arena& operator=(const basic_numa_arena&);
+
+public:
+    explicit basic_numa_arena(
+        std::size_t chunk_size = pool_type::chunk_capacity)
+    {
+        int count = numa<char>::node_count();
+        for (int node = 0; node < count; ++node)
+        {
+            allocator_.emplace_back(new numa<char>(node));
+            pool_.emplace_back(
+                new pool_type(chunk_size, allocator_.back().get()));
+        }
+    }
+
+    std::size_t size() const noexcept
+    {
+        return pool_.size();
+    }
+
+    pool_type& at(int node) noexcept
+    {
+        assert((node >= 0) && (static_cast<std::size_t>(node) < size()));
+        return *pool_[static_cast<std::size_t>(node)];
+    }
+
+    // arena of the calling thread's node
+    // the node is looked up once per thread, pin threads to keep it right
+    pool_type& local() noexcept
+    {
+        static thread_local const int node = numa<char>::current_node();
+        return at((static_cast<std::size_t>(node) < size()) ? node : 0);
+    }
+
+    void* malloc(std::size_t size) noexcept
+    {
+        return local().malloc(size);
+    }
+
+    static void free(void*) noexcept
+    {   }
+
+    static void free(void*, std::size_t) noexcept
+    {   }
+
+    // single-threaded
+    void clear() noexcept
+    {
+        for (auto& p : pool_)
+            p->clear();
+    }
+};
+
+typedef basic_numa_arena<basic_shared_pool<numa<char>>> numa_arena;
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,114 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/config.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  position independent pointer for mapped memory (file_pool, shm_pool)
+ *  keeps the distance from itself to the target, so data stays valid
+ *  wherever the whole region is mapped; distance 0 points to itself,
+ *  nullptr is distance 1 (a byte right after the pointer is not reachable)
+ *  mapped memory has to be constructed, zero bytes are not nullptr
+ */
+
+template<class T>
+class offset_ptr
+{
+public:
+    using element_type = T;
+    using pointer = T*;
+
+private:
+    // never a distance to an aligned target
+    enum : std::ptrdiff_t { null = 1 };
+
+    std::ptrdiff_t offset_{null};
+
+    void set(const volatile void* p) noexcept
+    {
+        offset_ = p ? reinterpret_cast<const volatile char*>(p) -
+            reinterpret_cast<const volatile char*>(this) : null;
+    }
+
+public:
+    offset_ptr() = default;
+
+    offset_ptr(std::nullptr_t) noexcept
+    {   }
+
+    offset_ptr(pointer p) noexcept
+    {
+        set(p);
+    }
+
+    offset_ptr(const offset_ptr& other) noexcept
+    {
+        set(other.get());
+    }
+
+    template<class U, class = std::enable_if_t<
+        std::is_convertible<U*, T*>::value>>
+    offset_ptr(const offset_ptr<U>& other) noexcept
+    {
+        set(static_cast<pointer>(other.get()));
+    }
+
+    offset_ptr& operator=(const offset_ptr& other) noexcept
+    {
+        set(other.get());
+        return *this;
+    }
+
+    offset_ptr& operator=(pointer p) noexcept
+    {
+        set(p);
+        return *this;
+    }
+
+    pointer get() const noexcept
+    {
+        return (offset_ != null) ? reinterpret_cast<pointer>(
+            const_cast<char*>(reinterpret_cast<const char*>(this)) + offset_) :
+            nullptr;
+    }
+
+    std::add_lvalue_reference_t<T> operator*() const noexcept
+    {
+        return *get();
+    }
+
+    pointer operator->() const noexcept
+    {
+        return get();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return offset_ != null;
+    }
+
+    template<class U>
+    bool operator==(const offset_ptr<U>& other) const noexcept
+    {
+        return get() == other.get();
+    }
+
+    template<class U>
+    bool operator!=(const offset_ptr<U>& other) const noexcept
+    {
+        return get() != other.get();
+    }
+};
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,74 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <new>
+#include <memory_resource>
+
+namespace btdef {
+namespace allocator {
+
+/*
+ *  std::pmr::memory_resource over basic_pool
+ *  pool p; resource r(p);
+ *  std::pmr::vector<std::pmr::string> v(&r);
+ *  nested pmr containers pick up the same arena
+ *  alignments above basic_pool::max_alignment end up in std::bad_alloc
+ */
+
+template<class T>
+class basic_resource final
+    : public std::pmr::memory_resource
+{
+public:
+    using pool_type = basic_pool<T>;
+
+private:
+    pool_type& pool_;
+
+public:
+    explicit basic_resource(pool_type& pool) noexcept
+        : pool_(pool)
+    {   }
+
+    pool_type& pool() const noexcept
+    {
+        return pool_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void* ptr = pool_.aligned_malloc(bytes ? bytes : 1, alignment);
+        if (!ptr)
+            throw std::bad_alloc();
+
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes,
+        std::size_t alignment) override
+    {
+        pool_.free(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other)
+        const noexcept override
+    {
+        if (this == &other)
+            return true;
+
+        auto res = dynamic_cast<const basic_resource*>(&other);
+        return res && (&res->pool_ == &pool_);
+    }
+};
+
+typedef basic_resource<basic<char>> resource;
+
+} // namespace allocator
+} // namespace btdef
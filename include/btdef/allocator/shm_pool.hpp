@@ -0,0 +1,361 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/offset_ptr.hpp"
+
+#include <new>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cstdint>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace btdef {
+namespace allocator {
+namespace detail {
+
+/*
+ *  fixed size shared memory segment
+ *  from a name (shm_open) or from a descriptor (memfd_create)
+ */
+
+class shm_segment
+{
+public:
+    struct header
+    {
+        std::atomic<std::uint64_t> magic_;
+        std::uint64_t capacity_;
+        // bump offset from the segment start
+        std::atomic<std::uint64_t> size_;
+        std::atomic<std::uint64_t> root_;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+        "shared memory needs address-free atomics");
+
+    enum { header_size = BTDEF_ALLOCATOR_ALIGN(sizeof(header)) };
+
+    // "btdefsh" and version 1
+    static const std::uint64_t magic = 0x62746465667368ull << 8 | 1u;
+
+protected:
+    // not an int, shm_pool(std::size_t) would lose to it
+    struct adopt_fd
+    {
+        int fd;
+    };
+
+    int fd_{-1};
+    char* base_{nullptr};
+    std::size_t length_{};
+
+    shm_segment(const shm_segment&);
+    shm_segment& operator=(const shm_segment&);
+
+    [[noreturn]] void raise(const char* what)
+    {
+        int code = errno;
+        close();
+        throw std::system_error(code, std::generic_category(), what);
+    }
+
+    void map(int prot)
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+            raise("fstat");
+
+        length_ = static_cast<std::size_t>(st.st_size);
+        if (length_ < header_size)
+        {
+            errno = EINVAL;
+            raise("shm_segment");
+        }
+
+        void* ptr = ::mmap(nullptr, length_, prot, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED)
+            raise("mmap");
+        base_ = static_cast<char*>(ptr);
+    }
+
+    void create(std::size_t capacity)
+    {
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0)
+            raise("ftruncate");
+
+        map(PROT_READ|PROT_WRITE);
+
+        header* h = new (base_) header{};
+        h->capacity_ = capacity;
+        h->size_.store(header_size, std::memory_order_relaxed);
+        h->root_.store(0, std::memory_order_relaxed);
+        // published last, attach checks it
+        h->magic_.store(magic, std::memory_order_release);
+    }
+
+    void attach(int prot)
+    {
+        map(prot);
+
+        header* h = head();
+        if ((h->magic_.load(std::memory_order_acquire) != magic) ||
+            (h->capacity_ > length_))
+        {
+            errno = EINVAL;
+            raise("shm_segment");
+        }
+    }
+
+    void close() noexcept
+    {
+        if (base_)
+            ::munmap(base_, length_);
+        if (fd_ >= 0)
+            ::close(fd_);
+        base_ = nullptr;
+        fd_ = -1;
+    }
+
+    header* head() const noexcept
+    {
+        return reinterpret_cast<header*>(base_);
+    }
+
+    shm_segment() = default;
+
+    ~shm_segment() noexcept
+    {
+        close();
+    }
+
+public:
+    // to pass to other processes (fork, SCM_RIGHTS)
+    int fd() const noexcept
+    {
+        return fd_;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return static_cast<std::size_t>(head()->capacity_);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return static_cast<std::size_t>(
+            head()->size_.load(std::memory_order_acquire));
+    }
+
+    // segment offset of a pointer, 0 for nullptr
+    std::uint64_t offset(const void* ptr) const noexcept
+    {
+        return ptr ? static_cast<std::uint64_t>(
+            static_cast<const char*>(ptr) - base_) : 0;
+    }
+
+    static void unlink(const char* name) noexcept
+    {
+        assert(name);
+        ::shm_unlink(name);
+    }
+};
+
+} // namespace detail
+
+/*
+ *  shared memory arena for processes on one host
+ *  the builder allocates with a lock-free bump pointer inside the segment
+ *  and links data with offset_ptr, readers attach with shm_view
+ *
+ *  shm_pool pool("/ref-tables", 64 << 20);
+ *  pool.set_root(build(pool));
+ *  ...
+ *  shm_view view("/ref-tables");
+ *  auto tables = view.root<tables_t>();
+ *
+ *  an anonymous segment goes to other processes as a descriptor
+ *  shm_pool pool(64 << 20);
+ *  ...
+ *  auto view = shm_view::attach_fd(fd);
+ *
+ *  the capacity is fixed at creation
+ */
+
+class shm_pool
+    : public detail::shm_segment
+{
+    explicit shm_pool(adopt_fd a)
+    {
+        fd_ = a.fd;
+        attach(PROT_READ|PROT_WRITE);
+    }
+
+public:
+    // creates a new named segment, fails if it exists
+    shm_pool(const char* name, std::size_t capacity)
+    {
+        assert(name);
+        fd_ = ::shm_open(name, O_RDWR|O_CREAT|O_EXCL|O_CLOEXEC, 0644);
+        if (fd_ < 0)
+            raise("shm_open");
+
+        try
+        {
+            create(capacity);
+        }
+        catch (...)
+        {
+            // do not leave a half made segment behind
+            close();
+            ::shm_unlink(name);
+            throw;
+        }
+    }
+
+    // attaches to an existing named segment for writing
+    explicit shm_pool(const char* name)
+    {
+        assert(name);
+        fd_ = ::shm_open(name, O_RDWR|O_CLOEXEC, 0);
+        if (fd_ < 0)
+            raise("shm_open");
+        attach(PROT_READ|PROT_WRITE);
+    }
+
+    // creates an anonymous segment, share it through fd()
+    explicit shm_pool(std::size_t capacity)
+    {
+#if defined(__linux__)
+        fd_ = ::memfd_create("btdef-shm", MFD_CLOEXEC);
+        if (fd_ < 0)
+            raise("memfd_create");
+#else
+        char name[64];
+        std::snprintf(name, sizeof(name), "/btdef-shm-%ld-%p",
+            static_cast<long>(::getpid()), static_cast<void*>(this));
+        fd_ = ::shm_open(name, O_RDWR|O_CREAT|O_EXCL|O_CLOEXEC, 0600);
+        if (fd_ < 0)
+            raise("shm_open");
+        ::shm_unlink(name);
+#endif // __linux__
+        create(capacity);
+    }
+
+    // attaches to a descriptor of an existing segment for writing
+    // the descriptor is owned by the pool afterwards
+    static shm_pool attach_fd(int fd)
+    {
+        return shm_pool(adopt_fd{fd});
+    }
+
+    void* malloc(std::size_t size) noexcept
+    {
+        return aligned_malloc(size, BTDEF_ALLOCATOR_ALIGN(1));
+    }
+
+    // alignment is a power of two, safe to call from any process
+    void* aligned_malloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        if (!size || (alignment & (alignment - 1)))
+            return nullptr;
+
+        size = BTDEF_ALLOCATOR_ALIGN(size);
+
+        auto h = head();
+        std::uint64_t top = h->size_.load(std::memory_order_relaxed);
+        std::uint64_t offset;
+        do
+        {
+            // the segment start is page aligned
+            offset = (top + alignment - 1) & ~std::uint64_t(alignment - 1);
+            if (offset + size > h->capacity_)
+                return nullptr;
+        }
+        while (!h->size_.compare_exchange_weak(top, offset + size,
+            std::memory_order_relaxed, std::memory_order_relaxed));
+
+        return base_ + offset;
+    }
+
+    static void free(void*) noexcept
+    {   }
+
+    static void free(void*, std::size_t) noexcept
+    {   }
+
+    static void free(void*, std::size_t, std::size_t) noexcept
+    {   }
+
+    // publishes the data reachable from ptr to the readers
+    void set_root(const void* ptr) noexcept
+    {
+        head()->root_.store(offset(ptr), std::memory_order_release);
+    }
+
+    template<class T>
+    T* root() const noexcept
+    {
+        return static_cast<T*>(at(head()->root_.load(
+            std::memory_order_acquire)));
+    }
+
+    void* at(std::uint64_t offset) const noexcept
+    {
+        return offset ? base_ + offset : nullptr;
+    }
+};
+
+// read-only attachment to a shm_pool segment
+class shm_view
+    : public detail::shm_segment
+{
+    explicit shm_view(adopt_fd a)
+    {
+        fd_ = a.fd;
+        attach(PROT_READ);
+    }
+
+public:
+    explicit shm_view(const char* name)
+    {
+        assert(name);
+        fd_ = ::shm_open(name, O_RDONLY|O_CLOEXEC, 0);
+        if (fd_ < 0)
+            raise("shm_open");
+        attach(PROT_READ);
+    }
+
+    // the descriptor is owned by the view afterwards
+    static shm_view attach_fd(int fd)
+    {
+        return shm_view(adopt_fd{fd});
+    }
+
+    // nullptr until the builder calls set_root
+    template<class T>
+    const T* root() const noexcept
+    {
+        return static_cast<const T*>(at(head()->root_.load(
+            std::memory_order_acquire)));
+    }
+
+    const void* at(std::uint64_t offset) const noexcept
+    {
+        return offset ? base_ + offset : nullptr;
+    }
+};
+
+} // namespace allocator
+} // namespace btdef
@@ -0,0 +1,247 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/config.hpp"
+
+#include <cstdio>
+#include <cstddef>
+
+/*
+ *  allocation tracing for basic, basic_pool and wrapper
+ *  build with -DBTDEF_ALLOCATOR_TRACE=1, otherwise every hook is empty
+ *  counters live in per-thread buffers, dump() sums them up
+ *  wrapper<T>(pool, tag) attributes its allocations to the tag
+ */
+
+#if BTDEF_ALLOCATOR_TRACE
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+namespace btdef {
+namespace allocator {
+namespace trace {
+
+enum source {
+    // allocator::basic, memory from the system
+    system,
+    // new basic_pool chunks
+    chunk,
+    // basic_pool::malloc and aligned_malloc
+    pool,
+    source_count
+};
+
+enum { histogram_size = sizeof(std::size_t) * 8 };
+
+struct counter
+{
+    std::atomic<std::uint64_t> count_{};
+    std::atomic<std::uint64_t> bytes_{};
+
+    // only the owner thread writes, so no read-modify-write
+    void add(std::size_t size) noexcept
+    {
+        count_.store(count_.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+        bytes_.store(bytes_.load(std::memory_order_relaxed) + size,
+            std::memory_order_relaxed);
+    }
+
+    void merge(const counter& other) noexcept
+    {
+        count_.fetch_add(other.count_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        bytes_.fetch_add(other.bytes_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const noexcept
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t bytes() const noexcept
+    {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+};
+
+struct counters
+{
+    counter total_[source_count];
+    // log2 of the allocation size
+    counter histogram_[source_count][histogram_size];
+    counter tag_[BTDEF_ALLOCATOR_TRACE_TAGS];
+    // bytes copied when realloc could not grow in place
+    counter realloc_copy_;
+
+    void merge(const counters& other) noexcept
+    {
+        for (std::size_t s = 0; s < source_count; ++s)
+        {
+            total_[s].merge(other.total_[s]);
+            for (std::size_t i = 0; i < histogram_size; ++i)
+                histogram_[s][i].merge(other.histogram_[s][i]);
+        }
+        for (std::size_t i = 0; i < BTDEF_ALLOCATOR_TRACE_TAGS; ++i)
+            tag_[i].merge(other.tag_[i]);
+        realloc_copy_.merge(other.realloc_copy_);
+    }
+};
+
+class registry
+{
+    std::mutex mutex_{};
+    std::vector<const counters*> live_{};
+    // counters of finished threads
+    counters retired_{};
+
+public:
+    static registry& instance() noexcept
+    {
+        static registry r;
+        return r;
+    }
+
+    void attach(const counters* c)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        live_.push_back(c);
+    }
+
+    void detach(const counters* c) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_.merge(*c);
+        live_.erase(std::remove(live_.begin(), live_.end(), c), live_.end());
+    }
+
+    void collect(counters& result) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.merge(retired_);
+        for (auto c : live_)
+            result.merge(*c);
+    }
+};
+
+class local
+{
+    counters counters_{};
+
+public:
+    local()
+    {
+        registry::instance().attach(&counters_);
+    }
+
+    ~local()
+    {
+        registry::instance().detach(&counters_);
+    }
+
+    static counters& get() noexcept
+    {
+        static thread_local local l;
+        return l.counters_;
+    }
+};
+
+static inline std::size_t log2(std::size_t size) noexcept
+{
+    std::size_t i = 0;
+    while (size >>= 1)
+        ++i;
+    return i;
+}
+
+static inline void allocate(source s, std::size_t size) noexcept
+{
+    counters& c = local::get();
+    c.total_[s].add(size);
+    c.histogram_[s][log2(size)].add(size);
+}
+
+static inline void tag(unsigned t, std::size_t size) noexcept
+{
+    if (t >= BTDEF_ALLOCATOR_TRACE_TAGS)
+        t = BTDEF_ALLOCATOR_TRACE_TAGS - 1;
+    local::get().tag_[t].add(size);
+}
+
+static inline void realloc_copy(std::size_t size) noexcept
+{
+    local::get().realloc_copy_.add(size);
+}
+
+static inline void dump(std::FILE* out) noexcept
+{
+    static const char* name[] = { "system", "chunk", "pool" };
+
+    counters c;
+    registry::instance().collect(c);
+
+    for (std::size_t s = 0; s < source_count; ++s)
+    {
+        std::fprintf(out, "%s: count %llu, bytes %llu\n", name[s],
+            static_cast<unsigned long long>(c.total_[s].count()),
+            static_cast<unsigned long long>(c.total_[s].bytes()));
+        for (std::size_t i = 0; i < histogram_size; ++i)
+        {
+            const counter& h = c.histogram_[s][i];
+            if (h.count())
+                std::fprintf(out, "  [2^%zu, 2^%zu): count %llu, bytes %llu\n",
+                    i, i + 1, static_cast<unsigned long long>(h.count()),
+                    static_cast<unsigned long long>(h.bytes()));
+        }
+    }
+
+    for (std::size_t i = 0; i < BTDEF_ALLOCATOR_TRACE_TAGS; ++i)
+    {
+        const counter& t = c.tag_[i];
+        if (t.count())
+            std::fprintf(out, "tag %zu: count %llu, bytes %llu\n", i,
+                static_cast<unsigned long long>(t.count()),
+                static_cast<unsigned long long>(t.bytes()));
+    }
+
+    std::fprintf(out, "realloc copy: count %llu, bytes %llu\n",
+        static_cast<unsigned long long>(c.realloc_copy_.count()),
+        static_cast<unsigned long long>(c.realloc_copy_.bytes()));
+}
+
+} // namespace trace
+} // namespace allocator
+} // namespace btdef
+
+#define BTDEF_ALLOCATOR_TRACE_ALLOCATE(s, size) \
+    ::btdef::allocator::trace::allocate(::btdef::allocator::trace::s, size)
+#define BTDEF_ALLOCATOR_TRACE_TAG(t, size) \
+    ::btdef::allocator::trace::tag(t, size)
+#define BTDEF_ALLOCATOR_TRACE_REALLOC_COPY(size) \
+    ::btdef::allocator::trace::realloc_copy(size)
+
+#else
+
+namespace btdef {
+namespace allocator {
+namespace trace {
+
+static inline void dump(std::FILE*) noexcept
+{   }
+
+} // namespace trace
+} // namespace allocator
+} // namespace btdef
+
+#define BTDEF_ALLOCATOR_TRACE_ALLOCATE(s, size) ((void)0)
+#define BTDEF_ALLOCATOR_TRACE_TAG(t, size) ((void)0)
+#define BTDEF_ALLOCATOR_TRACE_REALLOC_COPY(size) ((void)0)
+
+#endif // BTDEF_ALLOCATOR_TRACE
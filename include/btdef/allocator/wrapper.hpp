@@ -12,13 +12,16 @@
 namespace btdef {
 namespace allocator {
 
-template <class T>
+// A - pool, slab or anything with malloc(size), free(ptr, size)
+// and aligned_malloc(size, alignment), free(ptr, size, alignment)
+// for over-aligned types
+template <class T, class A = pool>
 class wrapper
 {
 public:
     using value_type = T;
-    using allocator_type = pool;
-    using Traits = std::allocator_traits<wrapper<T>>;
+    using allocator_type = A;
+    using Traits = std::allocator_traits<wrapper<T, A>>;
     using pointer = typename std::allocator<T>::pointer;
     using const_pointer = typename std::allocator<T>::const_pointer;
     using reference = typename std::allocator<T>::reference;
@@ -27,6 +30,9 @@ public:
     using difference_type = typename std::allocator<T>::difference_type;
 
     allocator_type* base_{nullptr};
+#if BTDEF_ALLOCATOR_TRACE
+    unsigned tag_{};
+#endif // BTDEF_ALLOCATOR_TRACE
 
     wrapper() = default;
 
@@ -34,20 +40,42 @@ public:
         : base_(&base)
     {   }
 
+    // tag - call site id for the allocation trace
+    wrapper(allocator_type& base, unsigned tag)
+        : base_(&base)
+#if BTDEF_ALLOCATOR_TRACE
+        , tag_(tag)
+#endif // BTDEF_ALLOCATOR_TRACE
+    {
+        (void)tag;
+    }
+
     template<class U>
-    wrapper(const wrapper<U>& other)
+    wrapper(const wrapper<U, A>& other)
         : base_(other.base_)
+#if BTDEF_ALLOCATOR_TRACE
+        , tag_(other.tag_)
+#endif // BTDEF_ALLOCATOR_TRACE
     {   }
 
     pointer allocate(std::size_t n)
     {
         assert(base_);
-        return reinterpret_cast<pointer>(base_->malloc(n * sizeof(T)));
+        BTDEF_ALLOCATOR_TRACE_TAG(tag_, n * sizeof(T));
+        if constexpr (alignof(T) > BTDEF_ALLOCATOR_ALIGN(1))
+            return reinterpret_cast<pointer>(
+                base_->aligned_malloc(n * sizeof(T), alignof(T)));
+        else
+            return reinterpret_cast<pointer>(base_->malloc(n * sizeof(T)));
     }
-    void deallocate(pointer ptr, std::size_t)
+
+    void deallocate(pointer ptr, std::size_t n)
     {
         assert(base_);
-        base_->free(ptr);
+        if constexpr (alignof(T) > BTDEF_ALLOCATOR_ALIGN(1))
+            base_->free(ptr, n * sizeof(T), alignof(T));
+        else
+            base_->free(ptr, n * sizeof(T));
     }
 
     template<class U, class... Args>
@@ -65,17 +93,17 @@ public:
     template<class U>
     struct rebind
     {
-        using other = wrapper<U>;
+        using other = wrapper<U, A>;
     };
 
     template<class U>
-    bool operator==(const wrapper<U>& other) const noexcept
+    bool operator==(const wrapper<U, A>& other) const noexcept
     {
         return base_ == other.base_;
     }
 
     template<class U>
-    bool operator!=(const wrapper<U>& other) const noexcept
+    bool operator!=(const wrapper<U, A>& other) const noexcept
     {
         return !(*this == other);
     }
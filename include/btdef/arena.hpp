@@ -0,0 +1,27 @@
+#pragma once
+
+#include "btdef/allocator/wrapper.hpp"
+#include "btdef/allocator/basic_arena.hpp"
+#include "btdef/allocator/inline_pool.hpp"
+
+#include <string>
+#include <vector>
+
+namespace btdef {
+
+using btdef::allocator::pool;
+using btdef::allocator::arena;
+using btdef::allocator::inline_pool;
+
+template<class T>
+using arena_allocator = btdef::allocator::wrapper<T>;
+
+// btdef::inline_pool<1024> ws;
+// btdef::arena_vector<int> v{btdef::arena_allocator<int>{ws}};
+template<class T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+using arena_string =
+    std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+} // namespace btdef
@@ -33,5 +33,14 @@
 #endif // BTDEF_ALLOCATOR_64BIT
 #endif // BTDEF_ALLOCATOR_ALIGN
 
+// allocation tracing, see btdef/allocator/trace.hpp
+#ifndef BTDEF_ALLOCATOR_TRACE
+#define BTDEF_ALLOCATOR_TRACE 0
+#endif // BTDEF_ALLOCATOR_TRACE
+
+#ifndef BTDEF_ALLOCATOR_TRACE_TAGS
+#define BTDEF_ALLOCATOR_TRACE_TAGS 64
+#endif // BTDEF_ALLOCATOR_TRACE_TAGS
+
 
 
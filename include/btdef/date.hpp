@@ -1,6 +1,10 @@
 #pragma once
 
 #include "btdef/util/date.hpp"
+#include "btdef/util/date_ns.hpp"
+#include "btdef/util/clock.hpp"
+#include "btdef/util/tsc_clock.hpp"
+#include "btdef/util/date_batch.hpp"
 
 namespace btdef {
 namespace time {
@@ -8,10 +12,17 @@ namespace time {
 using btdef::util::time::now;
 using btdef::util::time::steady;
 using btdef::util::time::empty_tm_dst;
+using btdef::util::time::coarse_now;
+using btdef::util::time::coarse_clock;
+using btdef::util::time::cached_clock;
+using btdef::util::time::tsc_clock;
 
 } // namespace time
 
 using btdef::util::tm;
 using btdef::util::date;
+using btdef::util::date_ns;
+using btdef::util::parse_errc;
+using btdef::util::parse_batch;
 
 } // namspace btdef
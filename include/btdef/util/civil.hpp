@@ -0,0 +1,125 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <ctime>
+#include <cstdint>
+
+namespace btdef {
+namespace util {
+namespace civil {
+
+/*
+ *  proleptic gregorian calendar arithmetic
+ *  http://howardhinnant.github.io/date_algorithms.html
+ *  days count from 1970-01-01, months are 1-12, no libc and no year limit
+ */
+
+typedef std::int64_t days_t;
+typedef std::int64_t seconds_t;
+
+struct ymd
+{
+    std::int64_t year;
+    unsigned month;
+    unsigned day;
+};
+
+constexpr seconds_t seconds_per_day = 86400;
+
+// floor division, rounds to -inf for negative a
+constexpr std::int64_t floor_div(std::int64_t a, std::int64_t b) noexcept
+{
+    return (a >= 0 ? a : a - b + 1) / b;
+}
+
+constexpr bool is_leap(std::int64_t y) noexcept
+{
+    return (y % 4 == 0) && ((y % 100 != 0) || (y % 400 == 0));
+}
+
+constexpr unsigned last_day_of_month(std::int64_t y, unsigned m) noexcept
+{
+    return (m != 2) ? ((m ^ (m >> 3)) & 1) | 30 : (is_leap(y) ? 29 : 28);
+}
+
+constexpr days_t days_from_civil(std::int64_t y, unsigned m,
+    unsigned d) noexcept
+{
+    y -= m <= 2;
+    const std::int64_t era = floor_div(y, 400);
+    const std::int64_t yoe = y - era * 400;
+    const std::int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+constexpr ymd civil_from_days(days_t z) noexcept
+{
+    z += 719468;
+    const std::int64_t era = floor_div(z, 146097);
+    const std::int64_t doe = z - era * 146097;
+    const std::int64_t yoe =
+        (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const std::int64_t mp = (5 * doy + 2) / 153;
+    const unsigned d = static_cast<unsigned>(doy - (153 * mp + 2) / 5 + 1);
+    const unsigned m = static_cast<unsigned>(mp < 10 ? mp + 3 : mp - 9);
+    return ymd{yoe + era * 400 + (m <= 2), m, d};
+}
+
+// 0 is Sunday
+constexpr unsigned weekday_from_days(days_t z) noexcept
+{
+    return static_cast<unsigned>(z >= -4 ? (z + 4) % 7 : (z + 5) % 7 + 6);
+}
+
+// 0 is January 1
+constexpr unsigned day_of_year(std::int64_t y, unsigned m,
+    unsigned d) noexcept
+{
+    return static_cast<unsigned>(days_from_civil(y, m, d) -
+        days_from_civil(y, 1, 1));
+}
+
+// gmtime_r, tm_gmtoff and tm_zone stay zero
+constexpr std::tm to_tm(seconds_t t) noexcept
+{
+    const days_t days = floor_div(t, seconds_per_day);
+    const seconds_t sec = t - days * seconds_per_day;
+    const ymd date = civil_from_days(days);
+
+    std::tm tms{};
+    tms.tm_sec = static_cast<int>(sec % 60);
+    tms.tm_min = static_cast<int>(sec / 60 % 60);
+    tms.tm_hour = static_cast<int>(sec / 3600);
+    tms.tm_mday = static_cast<int>(date.day);
+    tms.tm_mon = static_cast<int>(date.month - 1);
+    tms.tm_year = static_cast<int>(date.year - 1900);
+    tms.tm_wday = static_cast<int>(weekday_from_days(days));
+    tms.tm_yday = static_cast<int>(days - days_from_civil(date.year, 1, 1));
+    return tms;
+}
+
+// timegm, out of range fields carry over like in timegm
+constexpr seconds_t from_tm(const std::tm& tms) noexcept
+{
+    const std::int64_t mon = tms.tm_mon;
+    const std::int64_t year = tms.tm_year + 1900 + floor_div(mon, 12);
+    const unsigned m = static_cast<unsigned>(mon - floor_div(mon, 12) * 12);
+
+    const days_t days = days_from_civil(year, m + 1, 1) + tms.tm_mday - 1;
+    return days * seconds_per_day + tms.tm_hour * seconds_t(3600) +
+        tms.tm_min * seconds_t(60) + tms.tm_sec;
+}
+
+static_assert(days_from_civil(1970, 1, 1) == 0, "civil epoch");
+static_assert(civil_from_days(-1).year == 1969, "civil negative days");
+static_assert(weekday_from_days(0) == 4, "1970-01-01 is Thursday");
+
+} // namespace civil
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,166 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/time.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+namespace btdef {
+namespace util {
+namespace time {
+
+// wall clock with the kernel tick resolution (1-4 ms), no vDSO math
+static inline time_point_t coarse_now() noexcept
+{
+#if defined(WIN32) || defined(_WIN32)
+    FILETIME ft;
+    ::GetSystemTimeAsFileTime(&ft);
+    return now(ft);
+#elif defined(CLOCK_REALTIME_COARSE)
+    using std::chrono::nanoseconds;
+    using std::chrono::system_clock;
+
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return time_point_t(std::chrono::duration_cast<system_clock::duration>(
+        nanoseconds(static_cast<std::int64_t>(ts.tv_sec) * 1000000000 +
+            ts.tv_nsec)));
+#else
+    return now();
+#endif
+}
+
+/*
+ *  clocks for date::now<Clock>() and date::log_time<Clock>()
+ *  with the system_clock time_point
+ */
+
+struct coarse_clock
+{
+    typedef std::chrono::system_clock::duration duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef time_point_t time_point;
+
+    static constexpr bool is_steady = false;
+
+    static time_point now() noexcept
+    {
+        return coarse_now();
+    }
+};
+
+/*
+ *  process wide cached now, reading it is one atomic load
+ *  the value moves with update() or with the ticker thread:
+ *
+ *  cached_clock::start(std::chrono::milliseconds(1));
+ *  ...
+ *  auto t = date::log_time<cached_clock>();
+ *
+ *  update() alone also works, now() returns its time until the next one
+ *  (an event loop iteration); with neither now() is coarse_now()
+ */
+
+class cached_clock
+{
+public:
+    typedef std::chrono::system_clock::duration duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef time_point_t time_point;
+
+    static constexpr bool is_steady = false;
+
+private:
+    struct state
+    {
+        std::atomic<rep> now_{};
+        std::mutex mutex_{};
+        std::condition_variable cv_{};
+        std::thread thread_{};
+        bool run_{false};
+
+        ~state() noexcept
+        {
+            stop();
+        }
+
+        void stop() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> l(mutex_);
+                run_ = false;
+            }
+            cv_.notify_all();
+
+            if (thread_.joinable())
+                thread_.join();
+        }
+    };
+
+    static state& instance() noexcept
+    {
+        static state s;
+        return s;
+    }
+
+public:
+    static time_point now() noexcept
+    {
+        rep value = instance().now_.load(std::memory_order_relaxed);
+        return value ? time_point(duration(value)) : coarse_now();
+    }
+
+    static time_point update() noexcept
+    {
+        time_point tp = time::now();
+        instance().now_.store(tp.time_since_epoch().count(),
+            std::memory_order_relaxed);
+        return tp;
+    }
+
+    // starts the ticker, false if it is already running
+    template<class Rep, class Period>
+    static bool start(std::chrono::duration<Rep, Period> resolution)
+    {
+        state& s = instance();
+        std::lock_guard<std::mutex> l(s.mutex_);
+        if (s.thread_.joinable())
+            return false;
+
+        update();
+        s.run_ = true;
+        s.thread_ = std::thread([&s, resolution]{
+            std::unique_lock<std::mutex> lock(s.mutex_);
+            while (!s.cv_.wait_for(lock, resolution, [&]{ return !s.run_; }))
+                update();
+        });
+
+        return true;
+    }
+
+    static bool start()
+    {
+        return start(std::chrono::milliseconds(1));
+    }
+
+    // now() goes back to coarse_now()
+    static void stop() noexcept
+    {
+        state& s = instance();
+        s.stop();
+        s.now_.store(0, std::memory_order_relaxed);
+    }
+};
+
+} // namespace time
+} // namespace util
+} // namespace btdef
@@ -11,9 +11,19 @@
 */
 
 #include "btdef/util/tm.hpp"
+#include "btdef/util/clock.hpp"
+#include "btdef/util/civil.hpp"
+#include "btdef/util/date_parse.hpp"
+#include "btdef/util/zone_cache.hpp"
+#include "btdef/util/json_stamp.hpp"
+#include "btdef/util/http_date.hpp"
+#if !defined(WIN32) && !defined(_WIN32)
+#include "btdef/util/tzif.hpp"
+#endif
 
 #include <algorithm>
 #include <stdexcept>
+#include <string_view>
 
 namespace btdef {
 namespace util {
@@ -49,66 +59,15 @@ private:
                 time_point<system_clock, microseconds>(microseconds(time)));
     }
 
-    static inline std::time_t to_time(const std::tm& tm,
-        minuteswest_t minuteswest) noexcept
+    // seconds the time_point holds
+    static std::time_t checked(civil::seconds_t sec)
     {
-        static const std::intptr_t mdays[] = {
-            0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
-        };
-
-        std::intptr_t year = tm.tm_year - 70;
-        std::intptr_t month = tm.tm_mon;
-        std::intptr_t day = tm.tm_mday;
-
-        if ((year < 0) || (year > 129)) /* algo only works for 1970-2099 */
-            return -1;
-
-        if ((month < 0) || (month > 11)) /* array bounds */
-            return -1;
-
-        if (day < 0)
-            return -1;
-
-        if ((month < 2) || ((year + 2) % 4))
-            --day;
-
-        if ((tm.tm_hour < 0) || (tm.tm_min < 0) || (tm.tm_sec < 0))
-            return -1;
-
-        std::time_t rc = tm.tm_hour * 3600 + tm.tm_min * 60 +
-                tm.tm_sec + minuteswest * 60;
-
-        rc += (year * 365 + (year + 1) / 4 + mdays[month] + day) * 86400u;
-
-        return rc;
-    }
-
-    static inline date make(const std::tm& tms,
-        millisecond_t millisecond, minuteswest_t minuteswest)
-    {
-        std::time_t second = to_time(tms, minuteswest);
-        if (second < 0)
-            throw std::runtime_error("parse date");
-
-        return date(second, millisecond);
-    }
-
-    template<class T>
-    static bool out_of_range(T from, T value, T to) noexcept
-    {
-        return (value < from) || (value > to);
-    }
-
-    template<class T>
-    static bool eq(T value, T n1) noexcept
-    {
-        return value == n1;
-    }
-
-    template<class T, class... A>
-    static bool eq(T value, T n1, A... nn) noexcept
-    {
-        return (value == n1) || eq(value, nn...);
+        using std::chrono::seconds;
+        constexpr auto limit = std::chrono::duration_cast<seconds>(
+            time_point_t::duration::max()).count() - 1;
+        if ((sec < -limit) || (sec > limit))
+            throw std::runtime_error("invalid date");
+        return static_cast<std::time_t>(sec);
     }
 
 public:
@@ -137,20 +96,36 @@ public:
     {   }
 #endif
 
+    // local time of the process timezone, fields carry over like in mktime
+    // tm_isdst only chooses for ambiguous and skipped times,
+    // see time::local_to_utc
     explicit date(const std::tm& tm, millisecond_t ms = 0)
     {
-        std::tm t = tm;
-        time_t sec = mktime(&t);
-        if (sec == static_cast<time_t>(-1))
-            throw std::runtime_error("invalid date");
+        auto info = time::local_to_utc(civil::from_tm(tm),
+            [](std::time_t t) -> const time::zone_cache::offset_t& {
+                return time::zone_cache::offset(t);
+            });
+        time_point_ = create(checked(time::pick(info, tm.tm_isdst)),
+            ms * k_msec);
+    }
 
-        time_point_ = create(sec, ms * k_msec);
+#if !defined(WIN32) && !defined(_WIN32)
+    // local time in a zone of the tz database
+    date(const std::tm& tm, const time::tzif& zone, millisecond_t ms = 0)
+    {
+        auto info = time::local_to_utc(civil::from_tm(tm),
+            [&](std::time_t t) {
+                return zone.offset(t);
+            });
+        time_point_ = create(checked(time::pick(info, tm.tm_isdst)),
+            ms * k_msec);
     }
+#endif
 
     explicit date(const std::basic_string_view<char>& text)
     {
         if (!text.empty())
-            *this = parse(text.data());
+            *this = parse(text);
     }
 
     // ultrafast parser :)
@@ -163,70 +138,68 @@ public:
         : time_point_(create(sec, k_msec * msec))
     {   }
 
-    static inline date parse(const char *ptr)
+    // RFC 3339, see date_parse.hpp
+    static inline parse_errc try_parse(std::string_view str,
+        date& result) noexcept
     {
-        assert(ptr);
-
-        std::tm tms{};
-        millisecond_t msec = 0;
-        minuteswest_t minwest = 0;
-
-        using conv::antoutp;
-        ptr = antoutp<4>(ptr, -1900, tms.tm_year);
-        if (!eq(*ptr++, '-'))
-            return make(tms, msec, minwest);
-
-        ptr = antoutp<2>(ptr, -1, tms.tm_mon);
-        if (!eq(*ptr++, '-'))
-            return make(tms, msec, minwest);
-
-        ptr = antoutp<2>(ptr, tms.tm_mday);
-        if (!eq(*ptr++, 'T', 't'))
-            return make(tms, msec, minwest);
-
-        ptr = antoutp<2>(ptr, tms.tm_hour);
-        if (!eq(*ptr++, ':'))
-            return make(tms, msec, minwest);
+        std::int64_t sec;
+        std::uint32_t nsec;
+        auto rc = detail::parse_iso(str.data(), str.size(), sec, nsec);
+        if (rc != parse_errc::ok)
+            return rc;
 
-        ptr = antoutp<2>(ptr, tms.tm_min);
-        if (!eq(*ptr++, ':'))
-            return make(tms, msec, minwest);
+        // the time_point range is the only year limit
+        using std::chrono::seconds;
+        constexpr auto limit = std::chrono::duration_cast<seconds>(
+            time_point_t::duration::max()).count() - 1;
+        if ((sec < -limit) || (sec > limit))
+            return parse_errc::out_of_range;
 
-        ptr = antoutp<2>(ptr, tms.tm_sec);
-        if (!eq(*ptr++, '.'))
-            return make(tms, msec, minwest);
-
-        ptr = antoutp<3>(ptr, msec);
-
-        if (!eq(*ptr, 'Z', 'z'))
-        {
-            if (eq(*ptr++, '-'))
-            {
-                ptr = antoutp<2>(ptr, minwest);
-                minwest *= 60;
+        result = date(static_cast<std::time_t>(sec),
+            static_cast<millisecond_t>(nsec / k_usec));
+        return parse_errc::ok;
+    }
 
-                if (eq(*ptr, ':'))
-                    ++ptr;
+    static inline date parse(std::string_view str)
+    {
+        date result;
+        if (try_parse(str, result) != parse_errc::ok)
+            throw std::runtime_error("parse date");
+        return result;
+    }
 
-                if (!out_of_range('0', *ptr, '9'))
-                    antoutp<2>(ptr, minwest, minwest);
-            }
-            else
-            {
-                ptr = antoutp<2>(ptr, minwest);
-                minwest *= 60;
+    static inline date parse(const char *ptr)
+    {
+        assert(ptr);
+        return parse(std::string_view(ptr));
+    }
 
-                if (eq(*ptr, ':'))
-                    ++ptr;
+    // RFC 7231 HTTP-date, see http_date.hpp
+    static inline parse_errc try_parse_http(std::string_view str,
+        date& result) noexcept
+    {
+        std::int64_t sec;
+        auto rc = detail::parse_http(str.data(), str.size(),
+            static_cast<std::int64_t>(std::time(nullptr)), sec);
+        if (rc != parse_errc::ok)
+            return rc;
 
-                if (!out_of_range('0', *ptr, '9'))
-                    antoutp<2>(ptr, minwest, minwest);
+        using std::chrono::seconds;
+        constexpr auto limit = std::chrono::duration_cast<seconds>(
+            time_point_t::duration::max()).count() - 1;
+        if ((sec < -limit) || (sec > limit))
+            return parse_errc::out_of_range;
 
-                minwest = -minwest;
-            }
-        }
+        result = date(static_cast<std::time_t>(sec), 0);
+        return parse_errc::ok;
+    }
 
-        return make(tms, msec, minwest);
+    static inline date parse_http(std::string_view str)
+    {
+        date result;
+        if (try_parse_http(str, result) != parse_errc::ok)
+            throw std::runtime_error("parse date");
+        return result;
     }
 
     static inline date now() noexcept
@@ -234,6 +207,13 @@ public:
         return date(time::now());
     }
 
+    // date::now<time::cached_clock>()
+    template<class Clock>
+    static inline date now() noexcept
+    {
+        return date(time_point_t(Clock::now()));
+    }
+
     static inline date from_time_t(std::time_t t) noexcept
     {
         return date(time::from_time_t(t));
@@ -244,7 +224,7 @@ public:
     {
         using std::chrono::milliseconds;
         auto time = time_point_.time_since_epoch();
-        return std::chrono::duration_cast<milliseconds>(time).count();
+        return std::chrono::floor<milliseconds>(time).count();
     }
 
     std::time_t unix_time() const noexcept
@@ -269,7 +249,9 @@ public:
 
     millisecond_t millisecond() const noexcept
     {
-        return static_cast<millisecond_t>(time() % k_msec);
+        value_t val = time();
+        return static_cast<millisecond_t>(val -
+            civil::floor_div(val, k_msec) * k_msec);
     }
 
     bool operator==(date other) const noexcept
@@ -356,30 +338,36 @@ public:
 
     auto local_time() const noexcept
     {
-        std::tm tms;
         value_t val = time();
-        std::time_t sec = static_cast<std::time_t>(val / k_msec);
+        value_t sec = civil::floor_div(val, k_msec);
 #if defined(WIN32) || defined(_WIN32)
-        ::localtime_s(&tms, &sec);
+        std::tm tms;
+        std::time_t t = static_cast<std::time_t>(sec);
+        ::localtime_s(&tms, &t);
 #else
-        ::localtime_r(&sec, &tms);
+        std::tm tms = time::zone_cache::local_time(
+            static_cast<std::time_t>(sec));
 #endif //
         return std::make_pair(std::move(tms),
-            static_cast<millisecond_t>(val % k_msec));
+            static_cast<millisecond_t>(val - sec * k_msec));
     }
 
+#if !defined(WIN32) && !defined(_WIN32)
+    auto local_time(const time::tzif& zone) const noexcept
+    {
+        value_t val = time();
+        value_t sec = civil::floor_div(val, k_msec);
+        return std::make_pair(zone.local_time(static_cast<std::time_t>(sec)),
+            static_cast<millisecond_t>(val - sec * k_msec));
+    }
+#endif
+
     auto utc_time() const noexcept
     {
-        std::tm tms;
         value_t val = time();
-        std::time_t sec = static_cast<std::time_t>(val / k_msec);
-#if defined(WIN32) || defined(_WIN32)
-        ::gmtime_s(&tms, &sec);
-#else
-        ::gmtime_r(&sec, &tms);
-#endif //
-        return std::make_pair(std::move(tms),
-            static_cast<millisecond_t>(val % k_msec));
+        value_t sec = civil::floor_div(val, k_msec);
+        return std::make_pair(civil::to_tm(sec),
+            static_cast<millisecond_t>(val - sec * k_msec));
     }
 
     class local final
@@ -403,6 +391,13 @@ public:
 #endif
         {   }
 
+#if !defined(WIN32) && !defined(_WIN32)
+        // any zone, zone() and zonename() as well
+        local(date d, const time::tzif& zone) noexcept
+            : tm(d.local_time(zone))
+        {   }
+#endif
+
         local& operator=(date d)
         {
             local l(d);
@@ -426,7 +421,12 @@ public:
 
         minuteswest_t timezone_offset() const noexcept
         {
-            return (tm_.tm_isdst != 0) ? minuteswest() - 60 : minuteswest();
+#if defined(WIN32) || defined(_WIN32)
+            return (tm_.tm_isdst > 0) ? minuteswest() - 60 : minuteswest();
+#else
+            // tm_gmtoff already has the DST shift
+            return minuteswest();
+#endif
         }
 
         char* put_json(char *p, minuteswest_t tz) const noexcept
@@ -466,17 +466,20 @@ public:
 
         util::text zone() const noexcept
         {
-            return tm::text("%z");
+            static constexpr time_format fmt("%z");
+            return tm::text(fmt);
         }
 
         util::text zonename() const noexcept
         {
-            return tm::text("%Z");
+            static constexpr time_format fmt("%Z");
+            return tm::text(fmt);
         }
 
         util::text text() const noexcept
         {
-            return text("%a %b %d %Y %H:%M:%S GMT%z (%Z)");
+            static constexpr time_format fmt("%a %b %d %Y %H:%M:%S GMT%z (%Z)");
+            return tm::text(fmt);
         }
 
         util::text text(const char *fmt) const noexcept
@@ -484,14 +487,21 @@ public:
             return tm::text(fmt);
         }
 
+        util::text text(const time_format& fmt) const noexcept
+        {
+            return tm::text(fmt);
+        }
+
         util::text date_text() const noexcept
         {
-            return tm::text("%a %b %d %Y");
+            static constexpr time_format fmt("%a %b %d %Y");
+            return tm::text(fmt);
         }
 
         util::text time_text() const noexcept
         {
-            return tm::text("%H:%M:%S GMT%z (%Z)");
+            static constexpr time_format fmt("%H:%M:%S GMT%z (%Z)");
+            return tm::text(fmt);
         }
 
         using tm::data;
@@ -500,14 +510,17 @@ public:
     };
 
 
+    // the offset is known, no zone lookup
     explicit date(const local& l)
     {
-        std::tm t{l.data()};
-        time_t sec = std::mktime(&t);
-        if (sec == static_cast<time_t>(-1))
-            throw std::runtime_error("invalid date");
-
-        time_point_ = create(sec, l.msec() * k_msec);
+        const std::tm& t = l.data();
+#if defined(WIN32) || defined(_WIN32)
+        const civil::seconds_t gmtoff = -l.timezone_offset() * 60;
+#else
+        const civil::seconds_t gmtoff = t.tm_gmtoff;
+#endif
+        time_point_ = create(checked(civil::from_tm(t) - gmtoff),
+            l.msec() * k_msec);
     }
 
     class utc final
@@ -543,7 +556,19 @@ public:
     // example : "Fri, 27 Nov 2015 19:16:51 GMT"
     util::text utc_text() const
     {
-        return utc(*this).text();
+        return http_text();
+    }
+
+    // the same as utc_text, IMF-fixdate for the Date header
+    // one shared stamp per second, see time::http_stamp
+    util::text http_text() const noexcept
+    {
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::http_stamp::shared().format(
+                civil::floor_div(time(), k_msec), p))));
+        return result;
     }
 
     // Returns a time as a string value.
@@ -565,9 +590,50 @@ public:
 
     util::text to_json() const noexcept
     {
-        return utc(*this).to_json();
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::json_stamp::utc().format(time(), 0, p))));
+        return result;
     }
 
+    // date::local(d).to_json() through the cached zone offset
+    util::text local_json() const noexcept
+    {
+        value_t val = time();
+        std::time_t sec = static_cast<std::time_t>(
+            civil::floor_div(val, k_msec));
+
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::json_stamp::local().format(val,
+                time::zone_cache::offset(sec).gmtoff, p))));
+        return result;
+    }
+
+#if !defined(WIN32) && !defined(_WIN32)
+    // the date in a zone of the tz database, see tzif.hpp
+    local local_in(const time::tzif& zone) const noexcept
+    {
+        return local(*this, zone);
+    }
+
+    util::text local_json(const time::tzif& zone) const noexcept
+    {
+        value_t val = time();
+        std::time_t sec = static_cast<std::time_t>(
+            civil::floor_div(val, k_msec));
+
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::json_stamp::local().format(val,
+                zone.offset(sec).gmtoff, p))));
+        return result;
+    }
+#endif
+
     util::text date_json() const
     {
         return utc(*this).date_json();
@@ -588,9 +654,17 @@ public:
         return local(*this).zonename();
     }
 
+    // cached_clock, one atomic load with its ticker running
+    // and the coarse clock resolution without
+    static inline util::text log_time()
+    {
+        return now<time::cached_clock>().local_json();
+    }
+
+    template<class Clock>
     static inline util::text log_time()
     {
-        return local(now()).to_json();
+        return now<Clock>().local_json();
     }
 };
 
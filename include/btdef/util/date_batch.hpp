@@ -0,0 +1,536 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/date_parse.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <cassert>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define BTDEF_UTIL_DATE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace btdef {
+namespace util {
+namespace detail {
+
+/*
+ *  YYYY-MM-DDThh:mm:ss.mmmZ is what we mostly read, rows of this form
+ *  take a two load SSE2 shape check and a fixed SWAR read,
+ *  the rest go through parse_iso
+ *
+ *  built with AVX2 (-mavx2, /arch:AVX2) eight rows go at once:
+ *  shape checks and digit pairs two rows per register, a transpose
+ *  to one field per register, then range checks and the day count
+ *  of all eight; rows it cannot take (other forms, years out of
+ *  1900-2155) fall back to the per-row path
+ *
+ *  this is not an order of magnitude over date::parse, that one is
+ *  SWAR too: canonical rows are 1.5-2.5 times faster with SSE2
+ *  and 2-4 times with AVX2 (see examples/date_batch)
+ *
+ *  the range is the one of date, system_clock::duration limits it
+ *  to 1677-2262 where that is nanoseconds, as date::try_parse does
+ */
+
+enum { canonical_size = 24 };
+
+#if defined(BTDEF_UTIL_DATE_SSE2)
+
+// bytes 0-15, YYYY-MM-DDThh:mm
+static inline __m128i head_lower() noexcept
+{
+    return _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x20, 0, 0, 0, 0, 0);
+}
+
+static inline __m128i head_shape() noexcept
+{
+    return _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0', '-',
+        '0', '0', 't', '0', '0', ':', '0', '0');
+}
+
+// bytes 8-23, DDThh:mm:ss.mmmZ
+static inline __m128i tail_lower() noexcept
+{
+    return _mm_setr_epi8(0, 0, 0x20, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0x20);
+}
+
+static inline __m128i tail_shape() noexcept
+{
+    return _mm_setr_epi8('0', '0', 't', '0', '0', ':', '0', '0',
+        ':', '0', '0', '.', '0', '0', '0', 'z');
+}
+
+enum {
+    head_digits = 0xdb6f,
+    head_seps = 0x2490,
+    tail_digits = 0x76db,
+    tail_seps = 0x8924
+};
+
+static inline int shape_mask(__m128i v, __m128i lower, __m128i shape,
+    int digits, int seps) noexcept
+{
+    const __m128i x = _mm_or_si128(v, lower);
+    const __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+    const __m128i digit =
+        _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    const __m128i sep = _mm_cmpeq_epi8(x, shape);
+    return (_mm_movemask_epi8(digit) & digits) |
+        (_mm_movemask_epi8(sep) & seps);
+}
+
+static inline bool check_canonical(const char* p) noexcept
+{
+    const __m128i head = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(p));
+    const __m128i tail = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(p + 8));
+    return (shape_mask(head, head_lower(), head_shape(),
+            head_digits, head_seps) == 0xffff) &&
+        (shape_mask(tail, tail_lower(), tail_shape(),
+            tail_digits, tail_seps) == 0xffff);
+}
+
+#else
+
+static inline bool check_canonical(const char* p) noexcept
+{
+    return check_shape(p, "dddd-dd-ddtdd:dd:dd.dddz", canonical_size);
+}
+
+#endif // BTDEF_UTIL_DATE_SSE2
+
+// fields of a checked canonical row
+static inline bool read_canonical(const char* p, std::int64_t& second,
+    std::uint32_t& nanosecond) noexcept
+{
+    const std::uint64_t a = swar_pairs(load64(p));
+    // DDThh:mm
+    const std::uint64_t b = swar_pairs(load64(p + 8));
+    // :ss.mmmZ
+    const std::uint64_t c = swar_pairs(load64(p + 16));
+
+    const unsigned year =
+        static_cast<unsigned>((a & 0xff) * 100 + ((a >> 16) & 0xff));
+    const unsigned mon = static_cast<unsigned>((a >> 40) & 0xff);
+    const unsigned day = static_cast<unsigned>(b & 0xff);
+    const std::uint64_t hour = (b >> 24) & 0xff;
+    const std::uint64_t min = (b >> 48) & 0xff;
+    const std::uint64_t sec = (c >> 8) & 0xff;
+    const std::uint64_t msec = ((c >> 32) & 0xff) * 10 + (p[22] & 0x0f);
+
+    std::int64_t days;
+    if (!days_from_civil4(year, mon, day, days) ||
+        ((mon > 12) | (hour > 23) | (min > 59) | (sec > 60)))
+        return false;
+
+    second = days * civil::seconds_per_day +
+        static_cast<std::int64_t>(hour * 3600 + min * 60 + sec);
+    nanosecond = static_cast<std::uint32_t>(msec * 1000000);
+    return true;
+}
+
+template<class Duration>
+static inline bool to_duration(std::int64_t sec, std::uint32_t nsec,
+    std::int64_t& result) noexcept
+{
+    using std::chrono::seconds;
+    using std::chrono::nanoseconds;
+    typedef std::chrono::system_clock::duration clock_duration;
+
+    constexpr auto own = std::chrono::duration_cast<seconds>(
+        Duration::max()).count();
+    constexpr auto clock = std::chrono::duration_cast<seconds>(
+        clock_duration::max()).count();
+    constexpr auto limit = ((own < clock) ? own : clock) - 1;
+    if ((sec < -limit) || (sec > limit))
+        return false;
+
+    // one by one, a sum in nanoseconds overflows after 2262
+    result = static_cast<std::int64_t>(
+        std::chrono::duration_cast<Duration>(seconds(sec)).count() +
+        std::chrono::floor<Duration>(nanoseconds(nsec)).count());
+    return true;
+}
+
+#if defined(BTDEF_UTIL_DATE_AVX2)
+
+// two rows, one per lane, the low 16 bits are the first row
+static inline unsigned shape_mask2(__m256i head, __m256i tail) noexcept
+{
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+
+    const __m256i h = _mm256_or_si256(head,
+        _mm256_broadcastsi128_si256(head_lower()));
+    const __m256i hd = _mm256_sub_epi8(h, zero);
+    const unsigned hmask = (static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(hd, nine), hd))) &
+            (head_digits * 0x10001u)) |
+        (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(h,
+            _mm256_broadcastsi128_si256(head_shape())))) &
+            (head_seps * 0x10001u));
+
+    const __m256i t = _mm256_or_si256(tail,
+        _mm256_broadcastsi128_si256(tail_lower()));
+    const __m256i td = _mm256_sub_epi8(t, zero);
+    const unsigned tmask = (static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(td, nine), td))) &
+            (tail_digits * 0x10001u)) |
+        (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(t,
+            _mm256_broadcastsi128_si256(tail_shape())))) &
+            (tail_seps * 0x10001u));
+
+    return hmask & tmask;
+}
+
+// words YY YY MM DD hh mm ss mm of two rows, the last millisecond
+// digit does not fit
+static inline __m256i digit_pairs2(__m256i head, __m256i tail) noexcept
+{
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i h = _mm256_shuffle_epi8(_mm256_sub_epi8(head, zero),
+        _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, 3, 5, 6, 8, 9,
+            11, 12, 14, 15, -1, -1, -1, -1)));
+    const __m256i t = _mm256_shuffle_epi8(_mm256_sub_epi8(tail, zero),
+        _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, 9, 10, 12, 13)));
+    return _mm256_maddubs_epi16(_mm256_or_si256(h, t),
+        _mm256_set1_epi16(0x010a));
+}
+
+// a <= b for unsigned words
+static inline __m128i le_epu16(__m128i a, __m128i b) noexcept
+{
+    return _mm_cmpeq_epi16(_mm_min_epu16(a, b), a);
+}
+
+// x * c in 64 bit lanes, c is below 2^32
+static inline __m256i mul64(__m256i x, std::uint32_t c) noexcept
+{
+    const __m256i m = _mm256_set1_epi64x(c);
+    return _mm256_add_epi64(_mm256_mul_epu32(x, m), _mm256_slli_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m), 32));
+}
+
+// seconds, milliseconds, microseconds or nanoseconds, these get
+// the whole row in vectors; the table years never overflow them
+template<class Duration>
+struct decimal_duration
+{
+    typedef typename Duration::period period;
+    static constexpr bool value =
+        std::is_integral<typename Duration::rep>::value &&
+        (period::num == 1) && ((period::den == 1) ||
+            (period::den == 1000) || (period::den == 1000000) ||
+            (period::den == 1000000000));
+};
+
+/*
+ *  eight rows, out gets the canonical rows that pass,
+ *  returns a bit per row that passed
+ */
+template<class Duration>
+static inline unsigned read_canonical8(const std::string_view* row,
+    std::int64_t* out) noexcept
+{
+    static constexpr year_table years{};
+    // bytes of the 16 bit tables, the high byte of a month word is zero
+    const __m128i last_day = _mm_setr_epi8(0, 31, 28, 31, 30, 31, 30, 31,
+        31, 30, 31, 30, 31, 0, 0, 0);
+    const __m128i before_lo = _mm_setr_epi8(0, 0, 31, 59, 90, 120,
+        static_cast<char>(151), static_cast<char>(181),
+        static_cast<char>(212), static_cast<char>(243),
+        static_cast<char>(273 & 0xff), static_cast<char>(304 & 0xff),
+        static_cast<char>(334 & 0xff), 0, 0, 0);
+    const __m128i before_hi = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 0, 0, 0);
+
+    unsigned canonical = 0;
+    __m128i f[8];
+    alignas(16) std::uint16_t last[8];
+    for (int k = 0; k < 8; k += 2)
+    {
+        __m128i h[2], t[2];
+        for (int j = 0; j < 2; ++j)
+        {
+            const std::string_view& r = row[k + j];
+            if (r.size() == canonical_size)
+            {
+                h[j] = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(r.data()));
+                t[j] = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(r.data() + 8));
+                last[k + j] = static_cast<std::uint16_t>(r[22] & 0x0f);
+            }
+            else
+            {
+                h[j] = t[j] = _mm_setzero_si128();
+                last[k + j] = 0;
+            }
+        }
+
+        const __m256i head = _mm256_set_m128i(h[1], h[0]);
+        const __m256i tail = _mm256_set_m128i(t[1], t[0]);
+        const unsigned m = shape_mask2(head, tail);
+        canonical |= (((m & 0xffff) == 0xffff) |
+            (((m >> 16) == 0xffff) << 1)) << k;
+
+        const __m256i w = digit_pairs2(head, tail);
+        f[k] = _mm256_castsi256_si128(w);
+        f[k + 1] = _mm256_extracti128_si256(w, 1);
+    }
+
+    if (!canonical)
+        return 0;
+
+    // one field of the eight rows per register
+    const __m128i t0 = _mm_unpacklo_epi16(f[0], f[1]);
+    const __m128i t1 = _mm_unpackhi_epi16(f[0], f[1]);
+    const __m128i t2 = _mm_unpacklo_epi16(f[2], f[3]);
+    const __m128i t3 = _mm_unpackhi_epi16(f[2], f[3]);
+    const __m128i t4 = _mm_unpacklo_epi16(f[4], f[5]);
+    const __m128i t5 = _mm_unpackhi_epi16(f[4], f[5]);
+    const __m128i t6 = _mm_unpacklo_epi16(f[6], f[7]);
+    const __m128i t7 = _mm_unpackhi_epi16(f[6], f[7]);
+    const __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+    const __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+    const __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+    const __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+    const __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+    const __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+    const __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+    const __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+    const __m128i year = _mm_add_epi16(_mm_mullo_epi16(
+        _mm_unpacklo_epi64(u0, u4), _mm_set1_epi16(100)),
+        _mm_unpackhi_epi64(u0, u4));
+    const __m128i mon = _mm_unpacklo_epi64(u1, u5);
+    const __m128i day = _mm_unpackhi_epi64(u1, u5);
+    const __m128i hour = _mm_unpacklo_epi64(u2, u6);
+    const __m128i min = _mm_unpackhi_epi64(u2, u6);
+    const __m128i sec = _mm_unpacklo_epi64(u3, u7);
+    const __m128i ms = _mm_add_epi16(_mm_mullo_epi16(
+        _mm_unpackhi_epi64(u3, u7), _mm_set1_epi16(10)),
+        _mm_load_si128(reinterpret_cast<const __m128i*>(last)));
+
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i yidx = _mm_sub_epi16(year,
+        _mm_set1_epi16(year_table::first));
+    const __m128i ok16 = _mm_and_si128(_mm_and_si128(
+        le_epu16(yidx, _mm_set1_epi16(year_table::size - 1)),
+        le_epu16(_mm_sub_epi16(mon, one), _mm_set1_epi16(11))),
+        _mm_and_si128(_mm_and_si128(
+            le_epu16(hour, _mm_set1_epi16(23)),
+            le_epu16(min, _mm_set1_epi16(59))),
+            le_epu16(sec, _mm_set1_epi16(60))));
+
+    const __m256i y = _mm256_i32gather_epi32(
+        reinterpret_cast<const int*>(years.data), _mm256_cvtepu16_epi32(
+            _mm_and_si128(yidx, _mm_set1_epi16(0xff))), 4);
+    const __m256i leap = _mm256_and_si256(y, _mm256_set1_epi32(1));
+
+    const __m256i mon32 = _mm256_cvtepu16_epi32(mon);
+    const __m256i day32 = _mm256_cvtepu16_epi32(day);
+    const __m256i last32 = _mm256_add_epi32(_mm256_cvtepu16_epi32(
+        _mm_shuffle_epi8(last_day, mon)), _mm256_and_si256(leap,
+            _mm256_cmpeq_epi32(mon32, _mm256_set1_epi32(2))));
+
+    const __m256i ok = _mm256_and_si256(_mm256_cvtepi16_epi32(ok16),
+        _mm256_and_si256(_mm256_cmpgt_epi32(day32, _mm256_setzero_si256()),
+            _mm256_cmpgt_epi32(_mm256_add_epi32(last32,
+                _mm256_set1_epi32(1)), day32)));
+
+    const unsigned result = canonical & static_cast<unsigned>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(ok)));
+    if (!result)
+        return 0;
+
+    constexpr int epoch = static_cast<int>(-civil::days_from_civil(
+        year_table::first, 1, 1));
+    const __m128i before = _mm_add_epi16(_mm_shuffle_epi8(before_lo, mon),
+        _mm_slli_epi16(_mm_shuffle_epi8(before_hi, mon), 8));
+    const __m256i days = _mm256_add_epi32(_mm256_add_epi32(
+        _mm256_sub_epi32(_mm256_srli_epi32(y, 1), _mm256_set1_epi32(epoch)),
+        _mm256_cvtepu16_epi32(before)), _mm256_add_epi32(
+            _mm256_and_si256(leap, _mm256_cmpgt_epi32(mon32,
+                _mm256_set1_epi32(2))),
+            _mm256_sub_epi32(day32, _mm256_set1_epi32(1))));
+
+    // hour * 3600 + min * 60 + sec
+    const __m128i hm_lo = _mm_madd_epi16(_mm_unpacklo_epi16(hour, min),
+        _mm_set1_epi32(3600 | (60 << 16)));
+    const __m128i hm_hi = _mm_madd_epi16(_mm_unpackhi_epi16(hour, min),
+        _mm_set1_epi32(3600 | (60 << 16)));
+    const __m256i sod = _mm256_add_epi32(_mm256_set_m128i(hm_hi, hm_lo),
+        _mm256_cvtepu16_epi32(sec));
+
+    const __m256i spd = _mm256_set1_epi64x(civil::seconds_per_day);
+    const __m256i lo = _mm256_add_epi64(_mm256_mul_epi32(
+        _mm256_cvtepi32_epi64(_mm256_castsi256_si128(days)), spd),
+        _mm256_cvtepi32_epi64(_mm256_castsi256_si128(sod)));
+    const __m256i hi = _mm256_add_epi64(_mm256_mul_epi32(
+        _mm256_cvtepi32_epi64(_mm256_extracti128_si256(days, 1)), spd),
+        _mm256_cvtepi32_epi64(_mm256_extracti128_si256(sod, 1)));
+
+    if constexpr (decimal_duration<Duration>::value)
+    {
+        constexpr auto den = Duration::period::den;
+        __m256i a = lo;
+        __m256i b = hi;
+        if constexpr (den > 1)
+        {
+            const __m256i scale = _mm256_set1_epi64x(den / 1000);
+            a = _mm256_add_epi64(mul64(lo, den), _mm256_mul_epu32(
+                _mm256_cvtepu16_epi64(ms), scale));
+            b = _mm256_add_epi64(mul64(hi, den), _mm256_mul_epu32(
+                _mm256_cvtepu16_epi64(_mm_srli_si128(ms, 8)), scale));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), b);
+        return result;
+    }
+    else
+    {
+        std::int64_t second[8];
+        std::uint16_t msec[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(second), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(second + 4), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(msec), ms);
+
+        unsigned passed = result;
+        for (int k = 0; k < 8; ++k)
+        {
+            if (((result >> k) & 1) && !to_duration<Duration>(second[k],
+                std::uint32_t(msec[k]) * 1000000u, out[k]))
+                passed &= ~(1u << k);
+        }
+        return passed;
+    }
+}
+
+#endif // BTDEF_UTIL_DATE_AVX2
+
+template<class Duration>
+static inline bool parse_row(const char* p, std::size_t n, bool canonical,
+    std::int64_t& result) noexcept
+{
+    std::int64_t sec;
+    std::uint32_t nsec;
+    if (canonical)
+        return read_canonical(p, sec, nsec) &&
+            to_duration<Duration>(sec, nsec, result);
+
+    return (parse_iso(p, n, sec, nsec) == parse_errc::ok) &&
+        to_duration<Duration>(sec, nsec, result);
+}
+
+// Row(i) gives the i-th row as a string_view
+template<class Duration, class Row>
+static inline std::size_t parse_rows(Row&& row, std::size_t count,
+    std::int64_t* out, std::uint8_t* valid) noexcept
+{
+    std::size_t result = 0;
+    std::size_t i = 0;
+
+#if defined(BTDEF_UTIL_DATE_AVX2)
+    const std::size_t blocks = count & ~std::size_t(7);
+    for (; i < blocks; i += 8)
+    {
+        std::string_view a[8];
+        for (std::size_t k = 0; k < 8; ++k)
+            a[k] = row(i + k);
+
+        const unsigned fast = read_canonical8<Duration>(a, out + i);
+        if (fast == 0xff)
+        {
+            if (valid)
+                std::memset(valid + i, 1, 8);
+            result += 8;
+            continue;
+        }
+
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            bool v = ((fast >> k) & 1) ||
+                parse_row<Duration>(a[k].data(), a[k].size(),
+                    (a[k].size() == canonical_size) &&
+                        check_canonical(a[k].data()), out[i + k]);
+            if (valid)
+                valid[i + k] = v;
+            result += v;
+        }
+    }
+#endif // BTDEF_UTIL_DATE_AVX2
+
+    for (; i < count; ++i)
+    {
+        std::string_view a = row(i);
+        bool canonical = (a.size() == canonical_size) &&
+            check_canonical(a.data());
+
+        bool v = parse_row<Duration>(a.data(), a.size(), canonical, out[i]);
+        if (valid)
+            valid[i] = v;
+        result += v;
+    }
+
+    return result;
+}
+
+} // namespace detail
+
+/*
+ *  batch RFC 3339 parsing into milliseconds (date::value_t)
+ *  or any other std::chrono duration since the epoch
+ *  valid[i] is 1 for parsed rows and 0 for the rest, valid may be nullptr
+ *  returns the number of parsed rows, out[i] of a bad row is unspecified
+ *
+ *  std::vector<std::int64_t> ms(rows.size());
+ *  std::vector<std::uint8_t> ok(rows.size());
+ *  parse_batch(rows.data(), rows.size(), ms.data(), ok.data());
+ */
+
+template<class Duration = std::chrono::milliseconds>
+std::size_t parse_batch(const std::string_view* rows, std::size_t count,
+    std::int64_t* out, std::uint8_t* valid = nullptr) noexcept
+{
+    assert(rows || !count);
+    assert(out || !count);
+
+    return detail::parse_rows<Duration>([rows](std::size_t i) {
+        return rows[i];
+    }, count, out, valid);
+}
+
+// fixed width rows stride bytes apart, trailing spaces and zeros are padding
+template<class Duration = std::chrono::milliseconds>
+std::size_t parse_batch(const char* data, std::size_t width,
+    std::size_t stride, std::size_t count,
+    std::int64_t* out, std::uint8_t* valid = nullptr) noexcept
+{
+    assert(data || !count);
+    assert(out || !count);
+    assert(width <= stride);
+
+    return detail::parse_rows<Duration>([=](std::size_t i) {
+        const char* p = data + i * stride;
+        std::size_t n = width;
+        while (n && ((p[n - 1] == ' ') || (p[n - 1] == '\0')))
+            --n;
+        return std::string_view(p, n);
+    }, count, out, valid);
+}
+
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,221 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/date.hpp"
+#include "btdef/util/date_batch.hpp"
+
+#include <ctime>
+#include <chrono>
+
+namespace btdef {
+namespace util {
+
+/*
+ *  date with nanoseconds, 1677-09-21 to 2262-04-11
+ *  timespec and timeval in and out, JSON with 3, 6 or 9 fraction digits
+ *
+ *  auto t = date_ns::now();
+ *  t.to_json(6); // 2015-11-27T19:16:51.123456Z
+ */
+
+class date_ns
+{
+public:
+    typedef std::int64_t value_t;
+    typedef time::timeval_t timeval_t;
+    typedef std::chrono::nanoseconds duration_t;
+    typedef std::chrono::time_point<std::chrono::system_clock,
+        duration_t> time_point_t;
+
+    enum {
+        k_nsec = 1000000000u
+    };
+
+private:
+
+    time_point_t time_point_{};
+
+public:
+
+    date_ns() = default;
+
+    explicit date_ns(time_point_t tp) noexcept
+        : time_point_(tp)
+    {   }
+
+    // nanoseconds since the epoch
+    explicit date_ns(value_t val) noexcept
+        : time_point_(duration_t(val))
+    {   }
+
+    explicit date_ns(const std::timespec& ts) noexcept
+        : time_point_(std::chrono::seconds(ts.tv_sec) +
+            duration_t(ts.tv_nsec))
+    {   }
+
+    explicit date_ns(const timeval_t& tv) noexcept
+        : time_point_(std::chrono::seconds(tv.tv_sec) +
+            std::chrono::microseconds(tv.tv_usec))
+    {   }
+
+    explicit date_ns(date d) noexcept
+        : time_point_(std::chrono::time_point_cast<duration_t>(
+            d.time_point()))
+    {   }
+
+    static inline date_ns now() noexcept
+    {
+        std::timespec ts;
+#if defined(WIN32) || defined(_WIN32)
+        std::timespec_get(&ts, TIME_UTC);
+#else
+        ::clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+        return date_ns(ts);
+    }
+
+    // RFC 3339 with up to 9 fraction digits, see date_parse.hpp
+    static inline parse_errc try_parse(std::string_view str,
+        date_ns& result) noexcept
+    {
+        std::int64_t sec;
+        std::uint32_t nsec;
+        auto rc = detail::parse_iso(str.data(), str.size(), sec, nsec);
+        if (rc != parse_errc::ok)
+            return rc;
+
+        value_t val;
+        if (!detail::to_duration<duration_t>(sec, nsec, val))
+            return parse_errc::out_of_range;
+
+        result = date_ns(val);
+        return parse_errc::ok;
+    }
+
+    static inline date_ns parse(std::string_view str)
+    {
+        date_ns result;
+        if (try_parse(str, result) != parse_errc::ok)
+            throw std::runtime_error("parse date");
+        return result;
+    }
+
+    // Gets the time value in nanoseconds.
+    value_t time() const noexcept
+    {
+        return time_point_.time_since_epoch().count();
+    }
+
+    std::time_t unix_time() const noexcept
+    {
+        return static_cast<std::time_t>(civil::floor_div(time(), k_nsec));
+    }
+
+    std::uint32_t nanosecond() const noexcept
+    {
+        value_t val = time();
+        return static_cast<std::uint32_t>(val -
+            civil::floor_div(val, k_nsec) * k_nsec);
+    }
+
+    time_point_t time_point() const noexcept
+    {
+        return time_point_;
+    }
+
+    std::timespec sys_time() const noexcept
+    {
+        std::timespec ts;
+        ts.tv_sec = unix_time();
+        ts.tv_nsec = static_cast<long>(nanosecond());
+        return ts;
+    }
+
+    // the nanoseconds are floored to microseconds
+    timeval_t to_timeval() const noexcept
+    {
+        return {
+            static_cast<decltype(timeval_t::tv_sec)>(unix_time()),
+            static_cast<decltype(timeval_t::tv_usec)>(nanosecond() / 1000)
+        };
+    }
+
+    // millisecond date, floored: truncated toward the past, not rounded
+    date to_date() const noexcept
+    {
+        return date(std::chrono::floor<date::time_point_t::duration>(
+            time_point_));
+    }
+
+    bool operator==(date_ns other) const noexcept
+    {
+        return time_point_ == other.time_point_;
+    }
+
+    bool operator<(date_ns other) const noexcept
+    {
+        return time_point_ < other.time_point_;
+    }
+
+    template<class Rep, class Period>
+    date_ns operator+(std::chrono::duration<Rep, Period> d) const noexcept
+    {
+        return date_ns(time_point_ + d);
+    }
+
+    template<class Rep, class Period>
+    date_ns operator-(std::chrono::duration<Rep, Period> d) const noexcept
+    {
+        return date_ns(time_point_ - d);
+    }
+
+    // nanoseconds
+    value_t operator-(date_ns other) const noexcept
+    {
+        return time() - other.time();
+    }
+
+    template<class Rep, class Period>
+    date_ns& operator+=(std::chrono::duration<Rep, Period> d) noexcept
+    {
+        time_point_ += d;
+        return *this;
+    }
+
+    template<class Rep, class Period>
+    date_ns& operator-=(std::chrono::duration<Rep, Period> d) noexcept
+    {
+        time_point_ -= d;
+        return *this;
+    }
+
+    // digits are 3, 6 or 9
+    util::text to_json(unsigned digits = 9) const noexcept
+    {
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::json_stamp::utc().format(unix_time(), nanosecond(),
+                digits, 0, p))));
+        return result;
+    }
+
+    util::text local_json(unsigned digits = 9) const noexcept
+    {
+        std::time_t sec = unix_time();
+
+        util::text result;
+        char* p = result.data();
+        result.resize(static_cast<std::size_t>(std::distance(p,
+            time::json_stamp::local().format(sec, nanosecond(), digits,
+                time::zone_cache::offset(sec).gmtoff, p))));
+        return result;
+    }
+};
+
+} // namespace util
+} // namespace btdef
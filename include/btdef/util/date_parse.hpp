@@ -0,0 +1,281 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/civil.hpp"
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BTDEF_UTIL_DATE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace btdef {
+namespace util {
+
+enum class parse_errc
+{
+    ok = 0,
+    // shorter than a date or a date with a time
+    bad_length,
+    // a digit or a separator is not in its place
+    bad_format,
+    // month, day or time fields, or beyond the date range
+    out_of_range,
+    // a dot without digits
+    bad_fraction,
+    bad_zone,
+    // characters after the zone
+    trailing
+};
+
+namespace detail {
+
+/*
+ *  RFC 3339 reader
+ *  YYYY-MM-DD[Thh:mm:ss[.f...][Z|+hh[[:]mm]|-hh[[:]mm]]]
+ *  a missing zone is UTC, fraction digits after the ninth are skipped
+ */
+
+// memory order, the first byte is the lowest
+static inline std::uint64_t load64(const char* p) noexcept
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// byte i gets 10 * digit(i) + digit(i + 1) for validated digits
+static inline std::uint64_t swar_pairs(std::uint64_t v) noexcept
+{
+    v &= 0x0f0f0f0f0f0f0f0full;
+    return v * 10 + (v >> 8);
+}
+
+static inline bool is_digit(char c) noexcept
+{
+    return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+// d - digit, other characters as they are, 't' matches 'T' and 't'
+static inline bool check_shape(const char* p, const char* shape,
+    std::size_t n) noexcept
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        char s = shape[i];
+        char c = p[i];
+        if (s == 'd' ? !is_digit(c) : ((s == 't' ? (c | 0x20) : c) != s))
+            return false;
+    }
+    return true;
+}
+
+// YYYY-MM-DDThh:mm:ss
+static inline bool check_date_time(const char* p) noexcept
+{
+#if defined(BTDEF_UTIL_DATE_SSE2)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    // lower case the 'T'
+    const __m128i x = _mm_or_si128(v,
+        _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x20, 0, 0, 0, 0, 0));
+    const __m128i shape = _mm_setr_epi8('0', '0', '0', '0', '-', '0', '0',
+        '-', '0', '0', 't', '0', '0', ':', '0', '0');
+
+    // digit if c - '0' <= 9 as unsigned
+    const __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+    const __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    const __m128i sep = _mm_cmpeq_epi8(x, shape);
+
+    const int mask = (_mm_movemask_epi8(digit) & 0xdb6f) |
+        (_mm_movemask_epi8(sep) & 0x2490);
+
+    return (mask == 0xffff) && (p[16] == ':') &&
+        is_digit(p[17]) && is_digit(p[18]);
+#else
+    return check_shape(p, "dddd-dd-ddtdd:dd:dd", 19);
+#endif
+}
+
+// days before each year of 1900-2155 shifted left, the low bit is leap
+struct year_table
+{
+    enum { first = 1900, size = 256 };
+
+    std::uint32_t data[size];
+
+    constexpr year_table() noexcept
+        : data{}
+    {
+        for (unsigned i = 0; i < size; ++i)
+        {
+            const std::int64_t y = first + i;
+            data[i] = static_cast<std::uint32_t>(
+                (civil::days_from_civil(y, 1, 1) -
+                    civil::days_from_civil(first, 1, 1)) << 1) |
+                civil::is_leap(y);
+        }
+    }
+};
+
+/*
+ *  days since 1970-01-01 for years 0-9999, false for a bad month or day
+ *  dates of the table years cost two loads, no branches on the fields
+ */
+static inline bool days_from_civil4(unsigned year, unsigned mon,
+    unsigned day, std::int64_t& days) noexcept
+{
+    static constexpr year_table years{};
+    static const unsigned short before[16] = {
+        0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 0, 0, 0
+    };
+    static const unsigned char last_day[16] = {
+        0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 0, 0, 0
+    };
+
+    constexpr std::int64_t epoch = -civil::days_from_civil(year_table::first,
+        1, 1);
+
+    unsigned leap;
+    std::int64_t first;
+    if (year - year_table::first < year_table::size)
+    {
+        const std::uint32_t y = years.data[year - year_table::first];
+        leap = y & 1;
+        first = static_cast<std::int64_t>(y >> 1) - epoch;
+    }
+    else
+    {
+        leap = ((year & 3) == 0) & ((year % 100 != 0) | (year % 400 == 0));
+        // one era ahead to stay unsigned for the year 0
+        const unsigned yy = year + 399;
+        first = static_cast<std::int64_t>(yy * 365 + yy / 4 - yy / 100 +
+            yy / 400) - (719162 + 146097);
+    }
+
+    mon &= 15;
+    days = first + before[mon] + (leap & (mon > 2)) + day - 1;
+    return (day - 1 < last_day[mon] + (leap & (mon == 2)));
+}
+
+static inline parse_errc parse_iso(const char* p, std::size_t n,
+    std::int64_t& second, std::uint32_t& nanosecond) noexcept
+{
+    if ((n < 10) || ((n > 10) && (n < 19)))
+        return parse_errc::bad_length;
+
+    std::uint64_t hour = 0, min = 0, sec = 0;
+    std::uint64_t ymd = 0;
+    std::uint64_t dt = 0;
+    std::size_t i = 10;
+
+    if (n == 10)
+    {
+        if (!check_shape(p, "dddd-dd-dd", 10))
+            return parse_errc::bad_format;
+
+        ymd = swar_pairs(load64(p));
+        dt = static_cast<std::uint64_t>((p[8] & 0x0f) * 10 + (p[9] & 0x0f));
+    }
+    else
+    {
+        if (!check_date_time(p))
+            return parse_errc::bad_format;
+
+        ymd = swar_pairs(load64(p));
+        // DDThh:mm
+        dt = swar_pairs(load64(p + 8));
+        hour = (dt >> 24) & 0xff;
+        min = (dt >> 48) & 0xff;
+        sec = static_cast<std::uint64_t>((p[17] & 0x0f) * 10 +
+            (p[18] & 0x0f));
+        i = 19;
+    }
+
+    const unsigned year =
+        static_cast<unsigned>((ymd & 0xff) * 100 + ((ymd >> 16) & 0xff));
+    const unsigned mon = static_cast<unsigned>((ymd >> 40) & 0xff);
+    const unsigned day = static_cast<unsigned>(dt & 0xff);
+
+    std::int64_t days;
+    if (!days_from_civil4(year, mon, day, days) || (mon > 12) ||
+        (hour > 23) || (min > 59) || (sec > 60))
+        return parse_errc::out_of_range;
+
+    std::uint32_t nsec = 0;
+    if ((i < n) && (p[i] == '.'))
+    {
+        std::size_t from = ++i;
+        std::uint32_t scale = 1000000000;
+        for (; (i < n) && is_digit(p[i]); ++i)
+        {
+            if (scale > 1)
+            {
+                scale /= 10;
+                nsec += static_cast<std::uint32_t>(p[i] - '0') * scale;
+            }
+        }
+
+        if (i == from)
+            return parse_errc::bad_fraction;
+    }
+
+    std::int64_t offset = 0;
+    if (i < n)
+    {
+        char c = p[i++];
+        if ((c == '+') || (c == '-'))
+        {
+            if ((n - i < 2) || !is_digit(p[i]) || !is_digit(p[i + 1]))
+                return parse_errc::bad_zone;
+
+            std::int64_t zh = (p[i] - '0') * 10 + (p[i + 1] - '0');
+            std::int64_t zm = 0;
+            i += 2;
+
+            bool colon = (i < n) && (p[i] == ':');
+            if (colon)
+                ++i;
+
+            if ((n - i >= 2) && is_digit(p[i]) && is_digit(p[i + 1]))
+            {
+                zm = (p[i] - '0') * 10 + (p[i + 1] - '0');
+                i += 2;
+            }
+            else if (colon)
+                return parse_errc::bad_zone;
+
+            if ((zh > 23) || (zm > 59))
+                return parse_errc::bad_zone;
+
+            offset = (zh * 60 + zm) * 60;
+            if (c == '-')
+                offset = -offset;
+        }
+        else if ((c | 0x20) != 'z')
+            return parse_errc::bad_zone;
+    }
+
+    if (i != n)
+        return parse_errc::trailing;
+
+    second = days * civil::seconds_per_day +
+        static_cast<std::int64_t>(hour * 3600 + min * 60 + sec) - offset;
+    nanosecond = nsec;
+
+    return parse_errc::ok;
+}
+
+} // namespace detail
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,301 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/date_parse.hpp"
+#include "btdef/num/itoa.hpp"
+
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace btdef {
+namespace util {
+namespace detail {
+
+/*
+ *  RFC 7231 HTTP-date reader, names are case sensitive
+ *  IMF-fixdate  Sun, 06 Nov 1994 08:49:37 GMT
+ *  rfc850-date  Sunday, 06-Nov-94 08:49:37 GMT
+ *  asctime-date Sun Nov  6 08:49:37 1994
+ *  the day name has to be a day name, it is not checked against the date
+ */
+
+static const char http_wday[] = "SunMonTueWedThuFriSat";
+static const char http_month[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// 0-6 or -1
+static inline int http_wday_index(const char* p) noexcept
+{
+    for (int i = 0; i < 7; ++i)
+        if (std::memcmp(p, http_wday + i * 3, 3) == 0)
+            return i;
+    return -1;
+}
+
+// 1-12 or 0
+static inline unsigned http_month_index(const char* p) noexcept
+{
+    for (unsigned i = 0; i < 12; ++i)
+        if (std::memcmp(p, http_month + i * 3, 3) == 0)
+            return i + 1;
+    return 0;
+}
+
+static inline unsigned http_digits(const char* p, std::size_t n) noexcept
+{
+    unsigned result = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        result = result * 10 + static_cast<unsigned>(p[i] - '0');
+    return result;
+}
+
+// hh:mm:ss
+static inline bool http_time(const char* p, std::int64_t& result) noexcept
+{
+    if (!check_shape(p, "dd:dd:dd", 8))
+        return false;
+
+    const unsigned hour = http_digits(p, 2);
+    const unsigned min = http_digits(p + 3, 2);
+    const unsigned sec = http_digits(p + 6, 2);
+    if ((hour > 23) || (min > 59) || (sec > 60))
+        return false;
+
+    result = hour * 3600 + min * 60 + sec;
+    return true;
+}
+
+// now is a second since the epoch, for the two digit years of rfc850
+static inline parse_errc parse_http(const char* p, std::size_t n,
+    std::int64_t now, std::int64_t& second) noexcept
+{
+    static const char* const wday_long[] = {
+        "Sunday", "Monday", "Tuesday", "Wednesday",
+        "Thursday", "Friday", "Saturday"
+    };
+
+    if (n < 24)
+        return parse_errc::bad_length;
+
+    if (http_wday_index(p) < 0)
+        return parse_errc::bad_format;
+
+    unsigned year, mon, day;
+    std::int64_t time;
+
+    if (p[3] == ',')
+    {
+        // Sun, 06 Nov 1994 08:49:37 GMT
+        if (n < 29)
+            return parse_errc::bad_length;
+
+        if (!check_shape(p + 4, " dd ", 4) || (p[11] != ' ') ||
+            !check_shape(p + 12, "dddd ", 5) || (p[25] != ' '))
+            return parse_errc::bad_format;
+
+        day = http_digits(p + 5, 2);
+        mon = http_month_index(p + 8);
+        year = http_digits(p + 12, 4);
+        if (!mon || !http_time(p + 17, time))
+            return parse_errc::out_of_range;
+
+        if (std::memcmp(p + 26, "GMT", 3) != 0)
+            return parse_errc::bad_zone;
+
+        if (n != 29)
+            return parse_errc::trailing;
+    }
+    else if (p[3] == ' ')
+    {
+        // Sun Nov  6 08:49:37 1994
+        if ((p[7] != ' ') || (p[10] != ' ') || (p[19] != ' ') ||
+            ((p[8] != ' ') && !is_digit(p[8])) || !is_digit(p[9]) ||
+            !check_shape(p + 20, "dddd", 4))
+            return parse_errc::bad_format;
+
+        mon = http_month_index(p + 4);
+        day = (p[8] == ' ') ? http_digits(p + 9, 1) : http_digits(p + 8, 2);
+        year = http_digits(p + 20, 4);
+        if (!mon || !http_time(p + 11, time))
+            return parse_errc::out_of_range;
+
+        if (n != 24)
+            return parse_errc::trailing;
+    }
+    else
+    {
+        // Sunday, 06-Nov-94 08:49:37 GMT
+        const char* name = wday_long[http_wday_index(p)];
+        const std::size_t size = std::strlen(name);
+        if (std::memcmp(p, name, size) != 0)
+            return parse_errc::bad_format;
+
+        p += size;
+        n -= size;
+        if (n < 24)
+            return parse_errc::bad_length;
+
+        if (!check_shape(p, ", dd-", 5) || (p[8] != '-') ||
+            !check_shape(p + 9, "dd ", 3) || (p[20] != ' '))
+            return parse_errc::bad_format;
+
+        day = http_digits(p + 2, 2);
+        mon = http_month_index(p + 5);
+        if (!mon || !http_time(p + 12, time))
+            return parse_errc::out_of_range;
+
+        if (std::memcmp(p + 21, "GMT", 3) != 0)
+            return parse_errc::bad_zone;
+
+        if (n != 24)
+            return parse_errc::trailing;
+
+        // more than 50 years ahead is the last century
+        const std::int64_t current =
+            civil::civil_from_days(civil::floor_div(now,
+                civil::seconds_per_day)).year;
+        std::int64_t y = current - current % 100 + http_digits(p + 9, 2);
+        if (y > current + 50)
+            y -= 100;
+
+        if ((y < 0) || (y > 9999))
+            return parse_errc::out_of_range;
+
+        year = static_cast<unsigned>(y);
+    }
+
+    std::int64_t days;
+    if (!days_from_civil4(year, mon, day, days))
+        return parse_errc::out_of_range;
+
+    second = days * civil::seconds_per_day + time;
+    return parse_errc::ok;
+}
+
+} // namespace detail
+
+namespace time {
+
+/*
+ *  IMF-fixdate of RFC 7231, Sun, 06 Nov 1994 08:49:37 GMT
+ *  shared() keeps the last formatted second behind a sequence lock,
+ *  readers copy four words, a writer that loses the race
+ *  formats into its own buffer and leaves the cache alone
+ */
+
+class http_stamp
+{
+public:
+    enum {
+        size = 29,
+        // format() copies this much
+        buffer_size = 32
+    };
+
+private:
+    std::atomic<std::uint64_t> sequence_{};
+    std::atomic<std::int64_t> second_{
+        std::numeric_limits<std::int64_t>::min()};
+    std::atomic<std::uint64_t> data_[buffer_size / 8];
+
+public:
+    http_stamp() noexcept
+    {
+        for (auto& w : data_)
+            w.store(0, std::memory_order_relaxed);
+    }
+
+    // size bytes and a zero for the years 0-9999, up to 40 otherwise
+    static char* put(std::int64_t second, char* p) noexcept
+    {
+        using num::detail::itoa;
+        using num::detail::itoa2zf;
+        using num::detail::itoa4zf;
+
+        const std::tm tms = civil::to_tm(second);
+
+        std::memcpy(p, detail::http_wday + tms.tm_wday * 3, 3);
+        p[3] = ',';
+        p[4] = ' ';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_mday), p + 5);
+        *p++ = ' ';
+        std::memcpy(p, detail::http_month + tms.tm_mon * 3, 3);
+        p[3] = ' ';
+        p += 4;
+
+        const std::int64_t year = tms.tm_year + std::int64_t(1900);
+        if ((year >= 0) && (year <= 9999))
+            p = itoa4zf(static_cast<std::uint32_t>(year), p);
+        else
+        {
+            if (year < 0)
+                *p++ = '-';
+            p = itoa(static_cast<std::uint32_t>(year < 0 ? -year : year), p);
+        }
+
+        *p++ = ' ';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_hour), p);
+        *p++ = ':';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_min), p);
+        *p++ = ':';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_sec), p);
+        std::memcpy(p, " GMT", 4);
+        p[4] = '\0';
+
+        return p + 4;
+    }
+
+    // seconds since the epoch, returns the end of the stamp
+    char* format(std::int64_t second, char* ptr) noexcept
+    {
+        std::uint64_t seq = sequence_.load(std::memory_order_acquire);
+        if (!(seq & 1) &&
+            (second_.load(std::memory_order_relaxed) == second))
+        {
+            std::uint64_t w[buffer_size / 8];
+            for (std::size_t i = 0; i < buffer_size / 8; ++i)
+                w[i] = data_[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == seq)
+            {
+                std::memcpy(ptr, w, buffer_size);
+                return ptr + size;
+            }
+        }
+
+        char* end = put(second, ptr);
+        if ((end != ptr + size) || (seq & 1) ||
+            !sequence_.compare_exchange_strong(seq, seq + 1,
+                std::memory_order_relaxed))
+            return end;
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::uint64_t w[buffer_size / 8];
+        std::memcpy(w, ptr, buffer_size);
+        second_.store(second, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < buffer_size / 8; ++i)
+            data_[i].store(w[i], std::memory_order_relaxed);
+
+        sequence_.store(seq + 2, std::memory_order_release);
+
+        return end;
+    }
+
+    static http_stamp& shared() noexcept
+    {
+        static http_stamp stamp;
+        return stamp;
+    }
+};
+
+} // namespace time
+} // namespace util
+} // namespace btdef
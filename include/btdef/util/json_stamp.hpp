@@ -0,0 +1,172 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/civil.hpp"
+#include "btdef/num/itoa.hpp"
+
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace btdef {
+namespace util {
+namespace time {
+
+/*
+ *  YYYY-MM-DDThh:mm:ss.mmm(Z|+hhmm) with the last second kept formatted
+ *  or with 6 and 9 fraction digits for date_ns
+ *  stamps within the same second rewrite the fraction only,
+ *  within the same minute the seconds and the milliseconds
+ *  one per thread for utc and one for local time (see date::to_json
+ *  and date::log_time)
+ */
+
+class json_stamp
+{
+public:
+    enum {
+        // YYYY-MM-DDThh:mm:ss.mmm+hhmm
+        max_size = 28,
+        // format() copies this much
+        buffer_size = 32,
+        second_offset = 17,
+        msec_offset = 20,
+        zone_offset = 23,
+        // YYYY-MM-DDThh:mm:ss.nnnnnnnnn+hhmm
+        max_ns_size = 34,
+        // format() with nanoseconds copies this much
+        ns_buffer_size = 38
+    };
+
+private:
+    std::int64_t second_{std::numeric_limits<std::int64_t>::min()};
+    std::int64_t minute_{std::numeric_limits<std::int64_t>::min()};
+    long gmtoff_{};
+    std::size_t size_{};
+    char data_[buffer_size];
+
+    void put_second(std::int64_t local) noexcept
+    {
+        using num::detail::itoa2zf;
+        itoa2zf(static_cast<std::uint32_t>(local - minute_ * 60),
+            data_ + second_offset);
+    }
+
+    void put_all(std::int64_t local) noexcept
+    {
+        using num::detail::itoa2zf;
+        using num::detail::itoa4zf;
+
+        const std::tm tms = civil::to_tm(local);
+
+        char* p = itoa4zf(static_cast<std::uint32_t>(tms.tm_year) + 1900,
+            data_);
+        *p++ = '-';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_mon) + 1, p);
+        *p++ = '-';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_mday), p);
+        *p++ = 'T';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_hour), p);
+        *p++ = ':';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_min), p);
+        *p++ = ':';
+        p = itoa2zf(static_cast<std::uint32_t>(tms.tm_sec), p);
+        *p++ = '.';
+        // milliseconds go later
+        p += 3;
+
+        // the same as date::local::put_json
+        long tz = gmtoff_ / 60;
+        if (tz)
+        {
+            if (tz > 0)
+                *p++ = '+';
+            else
+            {
+                tz = -tz;
+                *p++ = '-';
+            }
+            p = itoa2zf(static_cast<std::uint32_t>(tz / 60), p);
+            p = itoa2zf(static_cast<std::uint32_t>(tz % 60), p);
+        }
+        else
+            *p++ = 'Z';
+
+        size_ = static_cast<std::size_t>(p - data_);
+    }
+
+    void update(std::int64_t second, long gmtoff) noexcept
+    {
+        if ((second != second_) || (gmtoff != gmtoff_))
+        {
+            const std::int64_t local = second + gmtoff;
+            const std::int64_t minute = civil::floor_div(local, 60);
+            if ((minute != minute_) || (gmtoff != gmtoff_))
+            {
+                gmtoff_ = gmtoff;
+                minute_ = minute;
+                put_all(local);
+            }
+            else
+                put_second(local);
+
+            second_ = second;
+        }
+    }
+
+public:
+    // msec since the epoch, gmtoff in seconds east of utc
+    // writes buffer_size bytes to ptr, returns the end of the stamp
+    char* format(std::int64_t msec, long gmtoff, char* ptr) noexcept
+    {
+        const std::int64_t second = civil::floor_div(msec, 1000);
+        update(second, gmtoff);
+
+        num::detail::itoa3zf(static_cast<std::uint32_t>(msec - second * 1000),
+            data_ + msec_offset);
+
+        std::memcpy(ptr, data_, buffer_size);
+        return ptr + size_;
+    }
+
+    // 3, 6 or 9 fraction digits of nsec, writes ns_buffer_size bytes
+    char* format(std::int64_t second, std::uint32_t nsec, unsigned digits,
+        long gmtoff, char* ptr) noexcept
+    {
+        using num::detail::itoa3zf;
+
+        update(second, gmtoff);
+
+        std::memcpy(ptr, data_, msec_offset);
+        char* p = itoa3zf(nsec / 1000000, ptr + msec_offset);
+        if (digits > 3)
+            p = itoa3zf(nsec / 1000 % 1000, p);
+        if (digits > 6)
+            p = itoa3zf(nsec % 1000, p);
+
+        // the zone with some of the tail
+        std::memcpy(p, data_ + zone_offset, buffer_size - zone_offset);
+        return p + (size_ - zone_offset);
+    }
+
+    static json_stamp& utc() noexcept
+    {
+        static thread_local json_stamp stamp;
+        return stamp;
+    }
+
+    static json_stamp& local() noexcept
+    {
+        static thread_local json_stamp stamp;
+        return stamp;
+    }
+};
+
+} // namespace time
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,272 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <new>
+#include <cstring>
+#include <cassert>
+#include <utility>
+#include <string_view>
+
+namespace btdef {
+namespace util {
+
+/*
+ *  append-only string builder living in a pool (basic_pool, slab)
+ *  grows in place while its buffer is the last block of the pool,
+ *  always zero terminated
+ */
+
+template<class P = allocator::pool>
+class basic_pool_string
+{
+public:
+    using value_type = char;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using size_type = std::size_t;
+    using sv_type = std::basic_string_view<value_type>;
+    using pool_type = P;
+
+    enum { min_capacity = 32 };
+
+private:
+    pool_type* pool_{nullptr};
+    pointer data_{nullptr};
+    size_type size_{};
+    // including the terminating zero
+    size_type capacity_{};
+
+    void grow(size_type n)
+    {
+        assert(pool_);
+
+        size_type capacity = capacity_ * 2;
+        if (capacity < n)
+            capacity = n;
+        if (capacity < min_capacity)
+            capacity = min_capacity;
+
+        if (!pool_->expand(data_, capacity_, capacity))
+        {
+            pointer data = static_cast<pointer>(pool_->malloc(capacity));
+            if (!data)
+                throw std::bad_alloc();
+
+            if (size_)
+                std::memcpy(data, data_, size_);
+            deallocate();
+            data_ = data;
+        }
+
+        capacity_ = capacity;
+    }
+
+    void deallocate() noexcept
+    {
+        if (data_)
+            pool_->free(data_, capacity_);
+    }
+
+public:
+    explicit basic_pool_string(pool_type& pool) noexcept
+        : pool_(&pool)
+    {   }
+
+    basic_pool_string(pool_type& pool, sv_type text)
+        : pool_(&pool)
+    {
+        append(text);
+    }
+
+    basic_pool_string(const basic_pool_string& other)
+        : pool_(other.pool_)
+    {
+        append(other);
+    }
+
+    basic_pool_string(basic_pool_string&& other) noexcept
+        : pool_(other.pool_)
+        , data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0))
+    {   }
+
+    basic_pool_string& operator=(const basic_pool_string& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            append(other);
+        }
+        return *this;
+    }
+
+    basic_pool_string& operator=(basic_pool_string&& other) noexcept
+    {
+        if (this != &other)
+        {
+            deallocate();
+            pool_ = other.pool_;
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+
+    ~basic_pool_string() noexcept
+    {
+        deallocate();
+    }
+
+    pool_type& pool() const noexcept
+    {
+        return *pool_;
+    }
+
+    void reserve(size_type n)
+    {
+        if (n + 1 > capacity_)
+            grow(n + 1);
+    }
+
+    basic_pool_string& append(const_pointer value, size_type len)
+    {
+        if (len)
+        {
+            assert(value);
+            if ((data_ <= value) && (value < data_ + size_))
+            {
+                // appending a part of itself
+                size_type offset = static_cast<size_type>(value - data_);
+                reserve(size_ + len);
+                value = data_ + offset;
+            }
+            else
+                reserve(size_ + len);
+
+            std::memcpy(data_ + size_, value, len);
+            size_ += len;
+            data_[size_] = '\0';
+        }
+        return *this;
+    }
+
+    basic_pool_string& append(sv_type text)
+    {
+        return append(text.data(), text.size());
+    }
+
+    basic_pool_string& append(size_type n, value_type value)
+    {
+        if (n)
+        {
+            reserve(size_ + n);
+            std::memset(data_ + size_, value, n);
+            size_ += n;
+            data_[size_] = '\0';
+        }
+        return *this;
+    }
+
+    void push_back(value_type value)
+    {
+        append(1, value);
+    }
+
+    basic_pool_string& operator+=(sv_type text)
+    {
+        return append(text);
+    }
+
+    basic_pool_string& operator+=(value_type value)
+    {
+        push_back(value);
+        return *this;
+    }
+
+    void clear() noexcept
+    {
+        size_ = 0;
+        if (data_)
+            *data_ = '\0';
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    size_type length() const noexcept
+    {
+        return size_;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return capacity_ ? capacity_ - 1 : 0;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    pointer data() noexcept
+    {
+        return data_;
+    }
+
+    const_pointer data() const noexcept
+    {
+        return data_;
+    }
+
+    const_pointer c_str() const noexcept
+    {
+        return data_ ? data_ : "";
+    }
+
+    iterator begin() noexcept
+    {
+        return data_;
+    }
+
+    iterator end() noexcept
+    {
+        return data_ + size_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    sv_type str() const noexcept
+    {
+        return sv_type(data_, size_);
+    }
+
+    operator sv_type() const noexcept
+    {
+        return str();
+    }
+};
+
+typedef basic_pool_string<allocator::pool> pool_string;
+
+} // namespace util
+} // namespace btdef
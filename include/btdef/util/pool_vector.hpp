@@ -0,0 +1,348 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/allocator/basic_pool.hpp"
+
+#include <new>
+#include <cstring>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <initializer_list>
+
+namespace btdef {
+namespace util {
+
+/*
+ *  vector living in a pool (basic_pool, slab)
+ *  grows in place while its buffer is the last block of the pool,
+ *  otherwise moves to a new block, the old one goes back through free
+ *  element destructors run, the memory goes away with pool clear()
+ */
+
+template<class T, class P = allocator::pool>
+class basic_pool_vector
+{
+public:
+    using value_type = T;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using pool_type = P;
+
+    enum { min_capacity = 8 };
+
+private:
+    pool_type* pool_{nullptr};
+    pointer data_{nullptr};
+    size_type size_{};
+    size_type capacity_{};
+
+    static constexpr bool over_aligned() noexcept
+    {
+        return alignof(T) > BTDEF_ALLOCATOR_ALIGN(1);
+    }
+
+    pointer allocate(size_type n)
+    {
+        void* ptr;
+        if constexpr (over_aligned())
+            ptr = pool_->aligned_malloc(n * sizeof(T), alignof(T));
+        else
+            ptr = pool_->malloc(n * sizeof(T));
+
+        if (!ptr)
+            throw std::bad_alloc();
+        return static_cast<pointer>(ptr);
+    }
+
+    void deallocate() noexcept
+    {
+        if (data_)
+        {
+            if constexpr (over_aligned())
+                pool_->free(data_, capacity_ * sizeof(T), alignof(T));
+            else
+                pool_->free(data_, capacity_ * sizeof(T));
+        }
+    }
+
+    void grow(size_type n)
+    {
+        assert(pool_);
+
+        size_type capacity = capacity_ * 2;
+        if (capacity < n)
+            capacity = n;
+        if (capacity < min_capacity)
+            capacity = min_capacity;
+
+        if (pool_->expand(data_, capacity_ * sizeof(T), capacity * sizeof(T)))
+        {
+            capacity_ = capacity;
+            return;
+        }
+
+        pointer data = allocate(capacity);
+        if constexpr (std::is_trivially_copyable<T>::value)
+        {
+            if (size_)
+                std::memcpy(data, data_, size_ * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_move(data_, data_ + size_, data);
+            std::destroy(data_, data_ + size_);
+        }
+
+        deallocate();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+public:
+    explicit basic_pool_vector(pool_type& pool) noexcept
+        : pool_(&pool)
+    {   }
+
+    basic_pool_vector(pool_type& pool, std::initializer_list<T> list)
+        : pool_(&pool)
+    {
+        reserve(list.size());
+        for (auto& value : list)
+            push_back(value);
+    }
+
+    basic_pool_vector(const basic_pool_vector& other)
+        : pool_(other.pool_)
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    basic_pool_vector(basic_pool_vector&& other) noexcept
+        : pool_(other.pool_)
+        , data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0))
+    {   }
+
+    basic_pool_vector& operator=(const basic_pool_vector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    basic_pool_vector& operator=(basic_pool_vector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            deallocate();
+            pool_ = other.pool_;
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+
+    ~basic_pool_vector() noexcept
+    {
+        clear();
+        deallocate();
+    }
+
+    pool_type& pool() const noexcept
+    {
+        return *pool_;
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > capacity_)
+            grow(n);
+    }
+
+    void resize(size_type n)
+    {
+        if (n < size_)
+        {
+            std::destroy(data_ + n, data_ + size_);
+            size_ = n;
+        }
+        else
+        {
+            reserve(n);
+            std::uninitialized_value_construct(data_ + size_, data_ + n);
+            size_ = n;
+        }
+    }
+
+    template<class... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (size_ == capacity_)
+        {
+            // args may refer to the elements
+            T value(std::forward<Args>(args)...);
+            grow(size_ + 1);
+            pointer p = new (data_ + size_) T(std::move(value));
+            ++size_;
+            return *p;
+        }
+
+        pointer p = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return *p;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() noexcept
+    {
+        assert(size_);
+        std::destroy_at(data_ + --size_);
+    }
+
+    void clear() noexcept
+    {
+        std::destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    pointer data() noexcept
+    {
+        return data_;
+    }
+
+    const_pointer data() const noexcept
+    {
+        return data_;
+    }
+
+    reference operator[](size_type i) noexcept
+    {
+        assert(i < size_);
+        return data_[i];
+    }
+
+    const_reference operator[](size_type i) const noexcept
+    {
+        assert(i < size_);
+        return data_[i];
+    }
+
+    reference front() noexcept
+    {
+        assert(size_);
+        return *data_;
+    }
+
+    const_reference front() const noexcept
+    {
+        assert(size_);
+        return *data_;
+    }
+
+    reference back() noexcept
+    {
+        assert(size_);
+        return data_[size_ - 1];
+    }
+
+    const_reference back() const noexcept
+    {
+        assert(size_);
+        return data_[size_ - 1];
+    }
+
+    iterator begin() noexcept
+    {
+        return data_;
+    }
+
+    iterator end() noexcept
+    {
+        return data_ + size_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+};
+
+template<class T>
+using pool_vector = basic_pool_vector<T, allocator::pool>;
+
+} // namespace util
+} // namespace btdef
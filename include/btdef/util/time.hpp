@@ -74,28 +74,6 @@ static inline steady_point_t steady() noexcept
     return std::chrono::steady_clock::now();
 }
 
-static inline std::tm empty_tm_dst() noexcept
-{
-    std::tm tmdst{};
-    // вообще выглядит не очень
-    // но реальность она такая
-    // для mktime, на момент генерации таймстампа,
-    // нужен флаг учета летнего времени
-    // его можно узнать только запросив этот фалг
-    // перед генерацией таймстампа
-    std::tm tmst;
-    time_t t = std::time(nullptr);
-#if defined(WIN32) || defined(_WIN32)
-    localtime_s(&tmst, &t);
-#else
-    localtime_r(&t, &tmst);
-#endif
-    // такая вот грабелька
-    tmdst.tm_isdst = tmst.tm_isdst;
-    return tmdst;
-}
-
-
 } // namespace time
 } // namespace util
 } // namespace btdef
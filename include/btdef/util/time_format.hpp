@@ -0,0 +1,384 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/num/itoa.hpp"
+
+#include <ctime>
+#include <cstring>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace btdef {
+namespace util {
+
+/*
+ *  strftime pattern compiled into a list of operations
+ *  runs with C locale names and the itoa kernels:
+ *
+ *  static constexpr time_format fmt("%a, %d %b %Y %H:%M:%S GMT");
+ *  p = fmt.put(tm, p, size);
+ *
+ *  %a %A %b %h %B %d %e %H %I %M %S %y %Y %C %m %j %p %u %w %z %Z %n %t %%
+ *  and %D %F %R %T, the rest (locale forms like %c %x %X, modifiers)
+ *  make the whole pattern go through std::strftime
+ */
+
+class time_format
+{
+public:
+    enum {
+        max_ops = 32,
+        max_literal = 64
+    };
+
+private:
+    enum code : unsigned char
+    {
+        literal,
+        wday_short,
+        wday_long,
+        mon_short,
+        mon_long,
+        mday,
+        mday_space,
+        hour24,
+        hour12,
+        minute,
+        second,
+        year,
+        year2,
+        century,
+        mon,
+        yday,
+        ampm,
+        wday_num,
+        wday_num1,
+        zone_offset,
+        zone_name
+    };
+
+    struct op
+    {
+        code code_;
+        unsigned char size_;
+        unsigned char offset_;
+    };
+
+    const char* pattern_;
+    op ops_[max_ops];
+    char literal_[max_literal];
+    std::size_t count_;
+    std::size_t literal_size_;
+    bool native_;
+
+    constexpr void add(code c) noexcept
+    {
+        if (count_ == max_ops)
+            native_ = false;
+        else
+            ops_[count_++] = op{c, 0, 0};
+    }
+
+    constexpr void add(char ch) noexcept
+    {
+        if (literal_size_ == max_literal)
+        {
+            native_ = false;
+            return;
+        }
+
+        // continue the last literal
+        if (count_ && (ops_[count_ - 1].code_ == literal) &&
+            (ops_[count_ - 1].offset_ + ops_[count_ - 1].size_ ==
+                literal_size_))
+            ++ops_[count_ - 1].size_;
+        else if (count_ == max_ops)
+        {
+            native_ = false;
+            return;
+        }
+        else
+            ops_[count_++] = op{literal, 1,
+                static_cast<unsigned char>(literal_size_)};
+
+        literal_[literal_size_++] = ch;
+    }
+
+    constexpr void compile(const char* p) noexcept
+    {
+        for (; *p && native_; ++p)
+        {
+            if (*p != '%')
+            {
+                add(*p);
+                continue;
+            }
+
+            switch (*++p)
+            {
+            case 'a': add(wday_short); break;
+            case 'A': add(wday_long); break;
+            case 'b':
+            case 'h': add(mon_short); break;
+            case 'B': add(mon_long); break;
+            case 'd': add(mday); break;
+            case 'e': add(mday_space); break;
+            case 'H': add(hour24); break;
+            case 'I': add(hour12); break;
+            case 'M': add(minute); break;
+            case 'S': add(second); break;
+            case 'y': add(year2); break;
+            case 'Y': add(year); break;
+            case 'C': add(century); break;
+            case 'm': add(mon); break;
+            case 'j': add(yday); break;
+            case 'p': add(ampm); break;
+            case 'u': add(wday_num1); break;
+            case 'w': add(wday_num); break;
+#if defined(WIN32) || defined(_WIN32)
+            // no tm_gmtoff and tm_zone
+            case 'z':
+            case 'Z': native_ = false; break;
+#else
+            case 'z': add(zone_offset); break;
+            case 'Z': add(zone_name); break;
+#endif
+            case 'n': add('\n'); break;
+            case 't': add('\t'); break;
+            case '%': add('%'); break;
+            case 'D':
+                add(mon); add('/'); add(mday); add('/'); add(year2);
+                break;
+            case 'F':
+                add(year); add('-'); add(mon); add('-'); add(mday);
+                break;
+            case 'R':
+                add(hour24); add(':'); add(minute);
+                break;
+            case 'T':
+                add(hour24); add(':'); add(minute); add(':'); add(second);
+                break;
+            default:
+                native_ = false;
+                return;
+            }
+        }
+    }
+
+    static const char* wday_name(int i) noexcept
+    {
+        static const char* const name[] = {
+            "Sunday", "Monday", "Tuesday", "Wednesday",
+            "Thursday", "Friday", "Saturday"
+        };
+        return ((i >= 0) && (i < 7)) ? name[i] : "?";
+    }
+
+    static const char* mon_name(int i) noexcept
+    {
+        static const char* const name[] = {
+            "January", "February", "March", "April", "May", "June", "July",
+            "August", "September", "October", "November", "December"
+        };
+        return ((i >= 0) && (i < 12)) ? name[i] : "?";
+    }
+
+    static char* put_name(const char* name, std::size_t size,
+        char* p) noexcept
+    {
+        for (std::size_t i = 0; (i < size) && name[i]; ++i)
+            *p++ = name[i];
+        return p;
+    }
+
+    static char* put_int(long value, char* p) noexcept
+    {
+        if (value < 0)
+        {
+            *p++ = '-';
+            value = -value;
+        }
+        return num::detail::itoa(static_cast<std::uint32_t>(value), p);
+    }
+
+    static char* put2(int value, char* p) noexcept
+    {
+        if ((value >= 0) && (value < 100))
+            return num::detail::itoa2zf(static_cast<std::uint32_t>(value), p);
+        return put_int(value, p);
+    }
+
+    // the longest output of one op, %Z has its own check
+    enum { max_op_size = 16 };
+
+public:
+    constexpr explicit time_format(const char* pattern) noexcept
+        : pattern_(pattern)
+        , ops_{}
+        , literal_{}
+        , count_(0)
+        , literal_size_(0)
+        , native_(true)
+    {
+        compile(pattern);
+    }
+
+    const char* pattern() const noexcept
+    {
+        return pattern_;
+    }
+
+    // false if it runs through std::strftime
+    constexpr bool native() const noexcept
+    {
+        return native_;
+    }
+
+    // writes into [p, p + size), returns the end
+    // or nullptr if it does not fit, like strftime returning 0
+    char* put(const std::tm& tm, char* p, std::size_t size) const noexcept
+    {
+        assert(p);
+
+        if (!native_)
+        {
+            std::size_t rc = std::strftime(p, size, pattern_, &tm);
+            return (rc || !size || !*pattern_) ? p + rc : nullptr;
+        }
+
+        char* end = p + size;
+        for (std::size_t i = 0; i < count_; ++i)
+        {
+            const op& o = ops_[i];
+            const std::size_t need = (o.code_ == literal) ?
+                o.size_ : static_cast<std::size_t>(max_op_size);
+            if (static_cast<std::size_t>(end - p) <= need)
+                return nullptr;
+
+            switch (o.code_)
+            {
+            case literal:
+                std::memcpy(p, literal_ + o.offset_, o.size_);
+                p += o.size_;
+                break;
+            case wday_short:
+                p = put_name(wday_name(tm.tm_wday), 3, p);
+                break;
+            case wday_long:
+                p = put_name(wday_name(tm.tm_wday), 9, p);
+                break;
+            case mon_short:
+                p = put_name(mon_name(tm.tm_mon), 3, p);
+                break;
+            case mon_long:
+                p = put_name(mon_name(tm.tm_mon), 9, p);
+                break;
+            case mday:
+                p = put2(tm.tm_mday, p);
+                break;
+            case mday_space:
+                if ((tm.tm_mday >= 0) && (tm.tm_mday < 10))
+                {
+                    *p++ = ' ';
+                    *p++ = static_cast<char>('0' + tm.tm_mday);
+                }
+                else
+                    p = put2(tm.tm_mday, p);
+                break;
+            case hour24:
+                p = put2(tm.tm_hour, p);
+                break;
+            case hour12:
+                p = put2((tm.tm_hour % 12) ? tm.tm_hour % 12 : 12, p);
+                break;
+            case minute:
+                p = put2(tm.tm_min, p);
+                break;
+            case second:
+                p = put2(tm.tm_sec, p);
+                break;
+            case year:
+            {
+                long y = tm.tm_year + 1900l;
+                if ((y >= 1000) && (y <= 9999))
+                    p = num::detail::itoa4zf(static_cast<std::uint32_t>(y), p);
+                else
+                    p = put_int(y, p);
+                break;
+            }
+            case year2:
+            {
+                long y = (tm.tm_year + 1900l) % 100;
+                p = put2(static_cast<int>(y < 0 ? y + 100 : y), p);
+                break;
+            }
+            case century:
+            {
+                long y = tm.tm_year + 1900l;
+                if ((y >= 1000) && (y <= 9999))
+                    p = put2(static_cast<int>(y / 100), p);
+                else
+                    p = put_int((y >= 0) ? y / 100 : -((99 - y) / 100), p);
+                break;
+            }
+            case mon:
+                p = put2(tm.tm_mon + 1, p);
+                break;
+            case yday:
+                if ((tm.tm_yday >= 0) && (tm.tm_yday < 999))
+                    p = num::detail::itoa3zf(
+                        static_cast<std::uint32_t>(tm.tm_yday + 1), p);
+                else
+                    p = put_int(tm.tm_yday + 1, p);
+                break;
+            case ampm:
+                *p++ = (tm.tm_hour < 12) ? 'A' : 'P';
+                *p++ = 'M';
+                break;
+            case wday_num:
+                p = put_int(tm.tm_wday, p);
+                break;
+            case wday_num1:
+                p = put_int(tm.tm_wday ? tm.tm_wday : 7, p);
+                break;
+#if !defined(WIN32) && !defined(_WIN32)
+            case zone_offset:
+            {
+                long off = tm.tm_gmtoff / 60;
+                *p++ = (off < 0) ? '-' : '+';
+                off = (off < 0) ? -off : off;
+                p = put2(static_cast<int>(off / 60), p);
+                p = put2(static_cast<int>(off % 60), p);
+                break;
+            }
+            case zone_name:
+                if (tm.tm_zone)
+                {
+                    std::size_t n = std::strlen(tm.tm_zone);
+                    if (static_cast<std::size_t>(end - p) <= n)
+                        return nullptr;
+                    std::memcpy(p, tm.tm_zone, n);
+                    p += n;
+                }
+                break;
+#endif
+            default:
+                break;
+            }
+        }
+
+        if (p == end)
+            return nullptr;
+
+        *p = '\0';
+        return p;
+    }
+};
+
+} // namespace util
+} // namespace btdef
@@ -8,6 +8,7 @@
 #include "btdef/util/time.hpp"
 #include "btdef/num/itoa.hpp"
 #include "btdef/util/text.hpp"
+#include "btdef/util/time_format.hpp"
 #include "btdef/conv/string_traits.hpp"
 
 #include <utility>
@@ -158,9 +159,20 @@ public:
         return result;
     }
 
+    util::text text(const time_format& fmt) const noexcept
+    {
+        util::text result;
+        char* p = result.data();
+        char* e = fmt.put(tm_, p, util::text::cache_size);
+        result.resize(e ? static_cast<std::size_t>(std::distance(p, e)) : 0);
+
+        return result;
+    }
+
     util::text text() const noexcept
     {
-        return text("%a, %d %b %Y %H:%M:%S GMT");
+        static constexpr time_format fmt("%a, %d %b %Y %H:%M:%S GMT");
+        return text(fmt);
     }
 
     util::text millisecond() const noexcept
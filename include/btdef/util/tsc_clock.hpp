@@ -0,0 +1,333 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/time.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <condition_variable>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define BTDEF_UTIL_TSC_X86 1
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#define BTDEF_UTIL_TSC_X86 1
+#include <x86intrin.h>
+#include <cpuid.h>
+#elif defined(__aarch64__)
+#define BTDEF_UTIL_TSC_ARM64 1
+#endif
+
+namespace btdef {
+namespace util {
+namespace time {
+namespace detail {
+
+// the cycle counter, steady_clock nanoseconds where there is none
+static inline std::uint64_t read_tsc() noexcept
+{
+#if defined(BTDEF_UTIL_TSC_X86)
+    return __rdtsc();
+#elif defined(BTDEF_UTIL_TSC_ARM64)
+    std::uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// waits for the earlier instructions
+static inline std::uint64_t read_tscp() noexcept
+{
+#if defined(BTDEF_UTIL_TSC_X86)
+    unsigned aux;
+    return __rdtscp(&aux);
+#elif defined(BTDEF_UTIL_TSC_ARM64)
+    std::uint64_t v;
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#else
+    return read_tsc();
+#endif
+}
+
+// a counter with a constant rate in all P- and C-states
+static inline bool invariant_tsc() noexcept
+{
+#if defined(BTDEF_UTIL_TSC_X86)
+    unsigned r[4] = {};
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned>(info[0]) < 0x80000007)
+        return false;
+    __cpuid(info, 0x80000007);
+    r[3] = static_cast<unsigned>(info[3]);
+#else
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007)
+        return false;
+    __get_cpuid(0x80000007, &r[0], &r[1], &r[2], &r[3]);
+#endif
+    // edx bit 8
+    return (r[3] >> 8) & 1;
+#else
+    // the arm generic timer runs at a fixed rate
+    return true;
+#endif
+}
+
+} // namespace detail
+
+/*
+ *  wall clock from the cycle counter, rdtsc on x86, cntvct_el0 on arm64
+ *  and steady_clock elsewhere; start() checks for an invariant TSC,
+ *  calibrates for about 20 ms and starts the thread that
+ *  recalibrates against system_clock and steady_clock every period
+ *
+ *  tsc_clock::start();
+ *  auto a = tsc_clock::ticks();
+ *  ...
+ *  auto b = tsc_clock::ticks();
+ *  auto d = date(tsc_clock::to_time_point(a));
+ *  auto elapsed = tsc_clock::elapsed(a, b);
+ *
+ *  before start() now() reads the system clock
+ */
+
+class tsc_clock
+{
+public:
+    typedef std::chrono::system_clock::duration duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef time_point_t time_point;
+    typedef std::uint64_t ticks_t;
+
+    static constexpr bool is_steady = false;
+
+private:
+    struct sample
+    {
+        ticks_t tsc;
+        std::int64_t system;
+        std::int64_t steady;
+    };
+
+    struct state
+    {
+        // the calibration behind a sequence lock
+        std::atomic<std::uint64_t> sequence_{};
+        std::atomic<ticks_t> tsc_{};
+        std::atomic<std::int64_t> system_{};
+        std::atomic<std::int64_t> steady_{};
+        // nanoseconds per tick, zero before start()
+        std::atomic<double> scale_{};
+
+        // the first sample, the rate is measured from it
+        sample base_{};
+
+        std::mutex mutex_{};
+        std::condition_variable cv_{};
+        std::thread thread_{};
+        bool run_{false};
+
+        ~state() noexcept
+        {
+            stop();
+        }
+
+        void stop() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> l(mutex_);
+                run_ = false;
+            }
+            cv_.notify_all();
+
+            if (thread_.joinable())
+                thread_.join();
+        }
+
+        void store(const sample& s, double scale) noexcept
+        {
+            const std::uint64_t seq =
+                sequence_.load(std::memory_order_relaxed);
+            sequence_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            tsc_.store(s.tsc, std::memory_order_relaxed);
+            system_.store(s.system, std::memory_order_relaxed);
+            steady_.store(s.steady, std::memory_order_relaxed);
+            scale_.store(scale, std::memory_order_relaxed);
+
+            sequence_.store(seq + 2, std::memory_order_release);
+        }
+
+        // scale is zero before start()
+        void load(sample& s, double& scale) const noexcept
+        {
+            std::uint64_t seq;
+            do {
+                seq = sequence_.load(std::memory_order_acquire);
+                s.tsc = tsc_.load(std::memory_order_relaxed);
+                s.system = system_.load(std::memory_order_relaxed);
+                s.steady = steady_.load(std::memory_order_relaxed);
+                scale = scale_.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((seq & 1) ||
+                (seq != sequence_.load(std::memory_order_relaxed)));
+        }
+    };
+
+    static state& instance() noexcept
+    {
+        static state s;
+        return s;
+    }
+
+    template<class Clock>
+    static std::int64_t clock_ns() noexcept
+    {
+        using std::chrono::nanoseconds;
+        return std::chrono::duration_cast<nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+    }
+
+    // clocks read between two counter reads, the best of a few
+    static sample take() noexcept
+    {
+        using std::chrono::system_clock;
+        using std::chrono::steady_clock;
+
+        sample result{};
+        ticks_t window = ~ticks_t();
+        for (int i = 0; i < 5; ++i)
+        {
+            const ticks_t a = detail::read_tscp();
+            const std::int64_t system = clock_ns<system_clock>();
+            const std::int64_t steady = clock_ns<steady_clock>();
+            const ticks_t b = detail::read_tscp();
+            if (b - a < window)
+            {
+                window = b - a;
+                result = sample{a + (b - a) / 2, system, steady};
+            }
+        }
+        return result;
+    }
+
+    // a new anchor, the rate over the time since the first sample
+    static void calibrate(state& s) noexcept
+    {
+        const sample now = take();
+        const double ticks = static_cast<double>(now.tsc - s.base_.tsc);
+        if (ticks > 0)
+            s.store(now, static_cast<double>(now.steady -
+                s.base_.steady) / ticks);
+    }
+
+    static std::int64_t to_ns(ticks_t t, std::int64_t sample::* clock)
+        noexcept
+    {
+        sample s;
+        double scale;
+        instance().load(s, scale);
+        const std::int64_t delta =
+            static_cast<std::int64_t>(t - s.tsc);
+        return s.*clock +
+            static_cast<std::int64_t>(static_cast<double>(delta) * scale);
+    }
+
+public:
+    // the raw counter, the cheapest timestamp
+    static ticks_t ticks() noexcept
+    {
+        return detail::read_tsc();
+    }
+
+    static time_point now() noexcept
+    {
+        return started() ? to_time_point(ticks()) : time::now();
+    }
+
+    static bool started() noexcept
+    {
+        return instance().scale_.load(std::memory_order_relaxed) > 0;
+    }
+
+    static time_point to_time_point(ticks_t t) noexcept
+    {
+        using std::chrono::nanoseconds;
+        return time_point(std::chrono::duration_cast<duration>(
+            nanoseconds(to_ns(t, &sample::system))));
+    }
+
+    static steady_point_t to_steady(ticks_t t) noexcept
+    {
+        using std::chrono::nanoseconds;
+        using std::chrono::steady_clock;
+        return steady_point_t(std::chrono::duration_cast<
+            steady_clock::duration>(nanoseconds(to_ns(t, &sample::steady))));
+    }
+
+    static std::chrono::nanoseconds elapsed(ticks_t from, ticks_t to) noexcept
+    {
+        const double scale = instance().scale_.load(std::memory_order_relaxed);
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(
+            static_cast<double>(static_cast<std::int64_t>(to - from)) *
+                scale));
+    }
+
+    // throws std::runtime_error without an invariant TSC
+    // false if it is already running
+    template<class Rep, class Period>
+    static bool start(std::chrono::duration<Rep, Period> period)
+    {
+        if (!detail::invariant_tsc())
+            throw std::runtime_error("tsc is not invariant");
+
+        state& s = instance();
+        std::lock_guard<std::mutex> l(s.mutex_);
+        if (s.thread_.joinable())
+            return false;
+
+        if (!started())
+        {
+            s.base_ = take();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            calibrate(s);
+        }
+
+        s.run_ = true;
+        s.thread_ = std::thread([&s, period]{
+            std::unique_lock<std::mutex> lock(s.mutex_);
+            while (!s.cv_.wait_for(lock, period, [&]{ return !s.run_; }))
+                calibrate(s);
+        });
+
+        return true;
+    }
+
+    static bool start()
+    {
+        return start(std::chrono::seconds(1));
+    }
+
+    // the calibration stays, only the thread stops
+    static void stop() noexcept
+    {
+        instance().stop();
+    }
+};
+
+} // namespace time
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,491 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/civil.hpp"
+#include "btdef/util/zone_cache.hpp"
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace btdef {
+namespace util {
+namespace time {
+namespace detail {
+
+static inline std::uint32_t tzif_be32(const unsigned char* p) noexcept
+{
+    return static_cast<std::uint32_t>(p[0]) << 24 |
+        static_cast<std::uint32_t>(p[1]) << 16 |
+        static_cast<std::uint32_t>(p[2]) << 8 | p[3];
+}
+
+static inline std::int64_t tzif_be64(const unsigned char* p) noexcept
+{
+    return static_cast<std::int64_t>(
+        static_cast<std::uint64_t>(tzif_be32(p)) << 32 | tzif_be32(p + 4));
+}
+
+/*
+ *  POSIX TZ string of the TZif footer, the time after the last transition
+ *  std offset [dst [offset] [,start[/time],end[/time]]]
+ *  start and end are Jn, n or Mm.w.d, the time may be negative or past 24h
+ */
+
+class posix_tz
+{
+public:
+    struct rule
+    {
+        char kind;
+        int mon;
+        int week;
+        int day;
+        long time;
+    };
+
+    enum { name_size = 16 };
+
+private:
+    char std_name_[name_size]{};
+    char dst_name_[name_size]{};
+    long std_off_{};
+    long dst_off_{};
+    bool dst_{};
+    rule start_{};
+    rule end_{};
+
+    static bool parse_name(const char*& p, char* name) noexcept
+    {
+        std::size_t n = 0;
+        if (*p == '<')
+        {
+            for (++p; *p && (*p != '>'); ++p)
+                if (n < name_size - 1)
+                    name[n++] = *p;
+            if (*p++ != '>')
+                return false;
+        }
+        else
+        {
+            for (; ((*p | 0x20) >= 'a') && ((*p | 0x20) <= 'z'); ++p)
+                if (n < name_size - 1)
+                    name[n++] = *p;
+        }
+        name[n] = '\0';
+        return n >= 3;
+    }
+
+    static bool parse_number(const char*& p, long& value) noexcept
+    {
+        if ((*p < '0') || (*p > '9'))
+            return false;
+
+        value = 0;
+        for (; (*p >= '0') && (*p <= '9'); ++p)
+            value = value * 10 + (*p - '0');
+        return true;
+    }
+
+    // [+-]hh[:mm[:ss]] in seconds
+    static bool parse_time(const char*& p, long& value) noexcept
+    {
+        long sign = 1;
+        if ((*p == '+') || (*p == '-'))
+            sign = (*p++ == '-') ? -1 : 1;
+
+        long h, m = 0, s = 0;
+        if (!parse_number(p, h))
+            return false;
+        if ((*p == ':') && !parse_number(++p, m))
+            return false;
+        if ((*p == ':') && !parse_number(++p, s))
+            return false;
+
+        value = sign * (h * 3600 + m * 60 + s);
+        return true;
+    }
+
+    static bool parse_rule(const char*& p, rule& r) noexcept
+    {
+        long a = 0, b = 0, c = 0;
+        if (*p == 'M')
+        {
+            if (!parse_number(++p, a) || (*p++ != '.') ||
+                !parse_number(p, b) || (*p++ != '.') ||
+                !parse_number(p, c) || (a < 1) || (a > 12) ||
+                (b < 1) || (b > 5) || (c > 6))
+                return false;
+            r.kind = 'M';
+        }
+        else if (*p == 'J')
+        {
+            if (!parse_number(++p, c) || (c < 1) || (c > 365))
+                return false;
+            r.kind = 'J';
+        }
+        else
+        {
+            if (!parse_number(p, c) || (c > 365))
+                return false;
+            r.kind = 'n';
+        }
+
+        r.mon = static_cast<int>(a);
+        r.week = static_cast<int>(b);
+        r.day = static_cast<int>(c);
+        r.time = 7200;
+        return (*p != '/') || parse_time(++p, r.time);
+    }
+
+    // the local day of the rule in the year
+    static civil::days_t rule_day(const rule& r, std::int64_t year) noexcept
+    {
+        const civil::days_t first = civil::days_from_civil(year, 1, 1);
+        if (r.kind == 'J')
+            return first + r.day - 1 +
+                ((r.day >= 60) && civil::is_leap(year));
+        if (r.kind == 'n')
+            return first + r.day;
+
+        const unsigned mon = static_cast<unsigned>(r.mon);
+        const civil::days_t day1 = civil::days_from_civil(year, mon, 1);
+        const int wday = static_cast<int>(civil::weekday_from_days(day1));
+        civil::days_t day = day1 + (r.day - wday + 7) % 7 + (r.week - 1) * 7;
+        const civil::days_t last =
+            day1 + civil::last_day_of_month(year, mon) - 1;
+        while (day > last)
+            day -= 7;
+        return day;
+    }
+
+public:
+    // false for a string it does not understand or an empty one
+    bool parse(const char* p) noexcept
+    {
+        if (!parse_name(p, std_name_) || !parse_time(p, std_off_))
+            return false;
+
+        // POSIX offsets are west of utc
+        std_off_ = -std_off_;
+        dst_off_ = std_off_;
+        dst_ = false;
+        if (!*p)
+            return true;
+
+        if (!parse_name(p, dst_name_))
+            return false;
+
+        dst_ = true;
+        dst_off_ = std_off_ + 3600;
+        if ((*p != ',') && *p)
+        {
+            if (!parse_time(p, dst_off_))
+                return false;
+            dst_off_ = -dst_off_;
+        }
+
+        if (!*p)
+        {
+            // US rules when there are none
+            start_ = rule{'M', 3, 2, 0, 7200};
+            end_ = rule{'M', 11, 1, 0, 7200};
+            return true;
+        }
+
+        return (*p++ == ',') && parse_rule(p, start_) && (*p++ == ',') &&
+            parse_rule(p, end_) && !*p;
+    }
+
+    zone_cache::offset_t offset(std::time_t t) const noexcept
+    {
+        const zone_cache::offset_t std_type{std_off_, 0, std_name_};
+        if (!dst_)
+            return std_type;
+
+        const std::int64_t year = civil::civil_from_days(
+            civil::floor_div(t + std_off_, civil::seconds_per_day)).year;
+
+        // both in utc, the start is in standard time, the end in dst
+        const std::int64_t start = rule_day(start_, year) *
+            civil::seconds_per_day + start_.time - std_off_;
+        const std::int64_t end = rule_day(end_, year) *
+            civil::seconds_per_day + end_.time - dst_off_;
+
+        const bool dst = (start < end) ?
+            ((t >= start) && (t < end)) : ((t < end) || (t >= start));
+
+        return dst ? zone_cache::offset_t{dst_off_, 1, dst_name_} : std_type;
+    }
+};
+
+} // namespace detail
+
+/*
+ *  one zone of the tz database, a TZif v2+ file mapped read only
+ *  the transitions are searched in place, times after the last one
+ *  follow the POSIX TZ footer; leap second corrections are ignored
+ *
+ *  time::tzif zone("Europe/Moscow");
+ *  auto l = d.local_in(zone);
+ *
+ *  names are relative to TZDIR or /usr/share/zoneinfo,
+ *  find() keeps loaded zones for the life of the process
+ */
+
+class tzif
+{
+public:
+    typedef zone_cache::offset_t offset_t;
+
+private:
+    enum { header_size = 44 };
+
+    unsigned char* base_{nullptr};
+    std::size_t length_{};
+
+    const unsigned char* times_{nullptr};
+    const unsigned char* index_{nullptr};
+    const unsigned char* types_{nullptr};
+    const char* abbr_{nullptr};
+    std::uint32_t timecnt_{};
+    std::uint32_t typecnt_{};
+    std::uint32_t charcnt_{};
+
+    detail::posix_tz footer_{};
+    bool has_footer_{};
+    std::string name_{};
+
+    tzif(const tzif&);
+    tzif& operator=(const tzif&);
+
+    [[noreturn]] void raise(const char* what)
+    {
+        int code = errno;
+        close();
+        throw std::system_error(code, std::generic_category(), what);
+    }
+
+    [[noreturn]] void bad_format()
+    {
+        errno = EINVAL;
+        raise("tzif");
+    }
+
+    void close() noexcept
+    {
+        if (base_)
+            ::munmap(base_, length_);
+        base_ = nullptr;
+    }
+
+    std::string path() const
+    {
+        if (name_.empty() || (name_[0] == '/'))
+            return name_;
+
+        const char* dir = std::getenv("TZDIR");
+        std::string result = (dir && *dir) ? dir : "/usr/share/zoneinfo";
+        result += '/';
+        result += name_;
+        return result;
+    }
+
+    void map()
+    {
+        if (name_.find("..") != std::string::npos)
+        {
+            errno = EINVAL;
+            raise("tzif");
+        }
+
+        int fd = ::open(path().c_str(), O_RDONLY|O_CLOEXEC);
+        if (fd < 0)
+            raise("open");
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            int code = errno;
+            ::close(fd);
+            errno = code;
+            raise("fstat");
+        }
+
+        length_ = static_cast<std::size_t>(st.st_size);
+        void* ptr = (length_ >= header_size) ?
+            ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0) :
+            MAP_FAILED;
+        int code = errno;
+        ::close(fd);
+
+        if (ptr == MAP_FAILED)
+        {
+            errno = (length_ >= header_size) ? code : EINVAL;
+            raise("mmap");
+        }
+        base_ = static_cast<unsigned char*>(ptr);
+    }
+
+    // the v2 header and data after the v1 block
+    void parse()
+    {
+        const unsigned char* p = base_;
+        const unsigned char* end = base_ + length_;
+
+        auto counts = [&](const unsigned char* h, std::uint32_t* c) {
+            if (std::memcmp(h, "TZif", 4) != 0)
+                bad_format();
+            for (int i = 0; i < 6; ++i)
+                c[i] = detail::tzif_be32(h + 20 + i * 4);
+        };
+
+        // isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt
+        std::uint32_t c[6];
+        counts(p, c);
+        if (p[4] < '2')
+            bad_format();
+
+        std::size_t v1 = std::size_t(c[3]) * 5 + std::size_t(c[4]) * 6 +
+            c[5] + std::size_t(c[2]) * 8 + c[1] + c[0];
+        if (std::size_t(end - p) < header_size * 2 + v1)
+            bad_format();
+
+        p += header_size + v1;
+        counts(p, c);
+        p += header_size;
+
+        timecnt_ = c[3];
+        typecnt_ = c[4];
+        charcnt_ = c[5];
+
+        std::size_t v2 = std::size_t(timecnt_) * 9 + std::size_t(typecnt_) * 6 +
+            charcnt_ + std::size_t(c[2]) * 12 + c[1] + c[0];
+        if (!typecnt_ || !charcnt_ || (std::size_t(end - p) < v2))
+            bad_format();
+
+        times_ = p;
+        index_ = times_ + std::size_t(timecnt_) * 8;
+        types_ = index_ + timecnt_;
+        abbr_ = reinterpret_cast<const char*>(types_ + typecnt_ * 6);
+
+        for (std::uint32_t i = 0; i < timecnt_; ++i)
+            if (index_[i] >= typecnt_)
+                bad_format();
+
+        for (std::uint32_t i = 0; i < typecnt_; ++i)
+            if (types_[i * 6 + 5] >= charcnt_)
+                bad_format();
+
+        // abbreviations end with a zero
+        if (abbr_[charcnt_ - 1] != '\0')
+            bad_format();
+
+        // \nTZ string\n
+        p += v2;
+        if ((p < end) && (*p == '\n'))
+        {
+            const std::size_t rest = static_cast<std::size_t>(end - p - 1);
+            const unsigned char* e = static_cast<const unsigned char*>(
+                std::memchr(p + 1, '\n', rest));
+            if (e)
+            {
+                std::string tz(reinterpret_cast<const char*>(p + 1),
+                    static_cast<std::size_t>(e - p - 1));
+                has_footer_ = footer_.parse(tz.c_str());
+            }
+        }
+    }
+
+    offset_t type(std::size_t i) const noexcept
+    {
+        const unsigned char* t = types_ + i * 6;
+        return offset_t{
+            static_cast<long>(static_cast<std::int32_t>(detail::tzif_be32(t))),
+            t[4], abbr_ + t[5]};
+    }
+
+public:
+    explicit tzif(std::string_view name)
+        : name_(name)
+    {
+        map();
+        parse();
+    }
+
+    ~tzif() noexcept
+    {
+        close();
+    }
+
+    const std::string& name() const noexcept
+    {
+        return name_;
+    }
+
+    offset_t offset(std::time_t t) const noexcept
+    {
+        // the last transition not after t
+        std::uint32_t lo = 0, hi = timecnt_;
+        while (lo < hi)
+        {
+            std::uint32_t mid = lo + (hi - lo) / 2;
+            if (detail::tzif_be64(times_ + std::size_t(mid) * 8) <= t)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if ((lo == timecnt_) && has_footer_)
+            return footer_.offset(t);
+
+        // before the first transition it is the first type
+        return type(lo ? index_[lo - 1] : 0);
+    }
+
+    // localtime_r for this zone, tm_zone lives as long as the zone
+    std::tm local_time(std::time_t t) const noexcept
+    {
+        const offset_t o = offset(t);
+        std::tm tms = civil::to_tm(t + o.gmtoff);
+        tms.tm_isdst = o.isdst;
+        tms.tm_gmtoff = o.gmtoff;
+        tms.tm_zone = o.zone;
+        return tms;
+    }
+
+    // loaded once, never unloaded
+    // a lock and a map lookup, keep the reference instead of a name
+    static const tzif& find(std::string_view name)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::unique_ptr<tzif>, std::less<>> zones;
+
+        std::lock_guard<std::mutex> l(mutex);
+        auto i = zones.find(name);
+        if (i == zones.end())
+            i = zones.emplace(std::string(name),
+                std::unique_ptr<tzif>(new tzif(name))).first;
+        return *i->second;
+    }
+};
+
+} // namespace time
+} // namespace util
+} // namespace btdef
@@ -0,0 +1,368 @@
+// Copyright © 2017 igor . ikonopistsev at gmail
+// This work is free. You can redistribute it and/or modify it under the
+// terms of the Do What The Fuck You Want To Public License, Version 2,
+// as published by Sam Hocevar. See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include "btdef/util/time.hpp"
+#include "btdef/util/civil.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+
+namespace btdef {
+namespace util {
+namespace time {
+
+/*
+ *  local time without the libc timezone lock
+ *  each thread keeps two utc offsets of the process timezone together with
+ *  the ranges [from, until) where they hold, the ranges end at DST
+ *  transitions; inside them local time is plain arithmetic
+ *
+ *  a time just outside a range adds the next range in that direction,
+ *  so the two ranges are the sides of the closest transition;
+ *  a time far from both is one localtime_r and the ranges stay,
+ *  a run of far times within a week starts over there
+ *
+ *  transitions are searched with weekly probes and a binary search,
+ *  so two transitions closer than a week apart may be missed
+ *  after setenv("TZ") + tzset() call invalidate()
+ */
+
+class zone_cache
+{
+public:
+    struct offset_t
+    {
+        long gmtoff;
+        int isdst;
+        const char* zone;
+    };
+
+private:
+    // how far the transition search goes, near is within one step
+    static constexpr std::time_t step = 7 * 86400;
+    static constexpr int max_steps = 56;
+    // far times in a row close to each other before the ranges move
+    static constexpr int far_limit = 8;
+
+    struct range_t
+    {
+        std::time_t from;
+        std::time_t until;
+        offset_t offset;
+
+        bool contains(std::time_t t) const noexcept
+        {
+            return (from <= t) && (t < until);
+        }
+    };
+
+    // the last added first
+    range_t range_[2]{{1, 0, {}}, {1, 0, {}}};
+    unsigned generation_{};
+    // the offset of a far time and the run of them
+    offset_t far_{};
+    std::time_t far_time_{};
+    int far_count_{};
+
+    static std::atomic<unsigned>& generation() noexcept
+    {
+        static std::atomic<unsigned> g{};
+        return g;
+    }
+
+    static std::tm localtime(std::time_t t) noexcept
+    {
+        std::tm tms{};
+#if defined(WIN32) || defined(_WIN32)
+        ::localtime_s(&tms, &t);
+#else
+        ::localtime_r(&t, &tms);
+#endif
+        return tms;
+    }
+
+    static offset_t make_offset(std::time_t t) noexcept
+    {
+        std::tm tms = localtime(t);
+
+        offset_t o;
+#if defined(WIN32) || defined(_WIN32)
+        long second;
+        ::_get_timezone(&second);
+        o.gmtoff = -second + (tms.tm_isdst > 0 ? 3600 : 0);
+        o.zone = nullptr;
+#else
+        o.gmtoff = tms.tm_gmtoff;
+        o.zone = tms.tm_zone;
+#endif
+        o.isdst = tms.tm_isdst;
+        return o;
+    }
+
+    static bool same(const std::tm& tms, const offset_t& o) noexcept
+    {
+#if defined(WIN32) || defined(_WIN32)
+        return tms.tm_isdst == o.isdst;
+#else
+        return (tms.tm_gmtoff == o.gmtoff) && (tms.tm_isdst == o.isdst) &&
+            (tms.tm_zone == o.zone || !std::strcmp(tms.tm_zone, o.zone));
+#endif
+    }
+
+    // the range of the offset at s, from s up to the next transition
+    static range_t forward(std::time_t s) noexcept
+    {
+        range_t r{s, s + step * max_steps, make_offset(s)};
+        for (std::time_t a = s; a < r.until; a += step)
+        {
+            std::time_t b = a + step;
+            if (!same(localtime(b), r.offset))
+            {
+                // first second in (a, b] where the offset changes
+                while (b - a > 1)
+                {
+                    std::time_t m = a + (b - a) / 2;
+                    if (same(localtime(m), r.offset))
+                        a = m;
+                    else
+                        b = m;
+                }
+                r.until = b;
+                break;
+            }
+        }
+        return r;
+    }
+
+    // the range of the offset at e - 1, from the previous transition up to e
+    static range_t backward(std::time_t e) noexcept
+    {
+        range_t r{e - step * max_steps, e, make_offset(e - 1)};
+        for (std::time_t b = e - 1; b > r.from; b -= step)
+        {
+            std::time_t a = b - step;
+            if (!same(localtime(a), r.offset))
+            {
+                // first second in (a, b] with the offset
+                while (b - a > 1)
+                {
+                    std::time_t m = a + (b - a) / 2;
+                    if (same(localtime(m), r.offset))
+                        b = m;
+                    else
+                        a = m;
+                }
+                r.from = b;
+                break;
+            }
+        }
+        return r;
+    }
+
+    // n is next to range_[i], the other one goes
+    const offset_t& replace(int i, const range_t& n) noexcept
+    {
+        if (!i)
+            range_[1] = range_[0];
+        range_[0] = n;
+        return range_[0].offset;
+    }
+
+    const offset_t& refresh(std::time_t t) noexcept
+    {
+        // next to a range, the ranges keep sides of one transition
+        for (int i = 0; i < 2; ++i)
+        {
+            const range_t& r = range_[i];
+            if (r.from > r.until)
+                continue;
+
+            if ((t >= r.until) && (t - r.until < step))
+            {
+                range_t n = forward(r.until);
+                while (t >= n.until)
+                    n = forward(n.until);
+                return replace(i, n);
+            }
+
+            if ((t < r.from) && (r.from - t <= step))
+            {
+                range_t n = backward(r.from);
+                while (t < n.from)
+                    n = backward(n.from);
+                return replace(i, n);
+            }
+        }
+
+        // far from both
+        if (far_count_ && (t > far_time_ - step) && (t < far_time_ + step))
+            ++far_count_;
+        else
+        {
+            far_time_ = t;
+            far_count_ = 1;
+        }
+
+        if ((range_[0].from > range_[0].until) || (far_count_ >= far_limit))
+        {
+            far_count_ = 0;
+            range_[1] = range_t{1, 0, {}};
+            range_[0] = forward(t);
+            return range_[0].offset;
+        }
+
+        far_ = make_offset(t);
+        return far_;
+    }
+
+    static zone_cache& instance() noexcept
+    {
+        static thread_local zone_cache cache;
+        return cache;
+    }
+
+public:
+    // utc offset of the process timezone at t
+    static const offset_t& offset(std::time_t t) noexcept
+    {
+        zone_cache& c = instance();
+        unsigned g = generation().load(std::memory_order_acquire);
+        if (c.generation_ != g)
+        {
+            c.generation_ = g;
+            c.range_[0] = c.range_[1] = range_t{1, 0, {}};
+            c.far_count_ = 0;
+        }
+
+        if (c.range_[0].contains(t))
+            return c.range_[0].offset;
+
+        if (c.range_[1].contains(t))
+            return c.range_[1].offset;
+
+        return c.refresh(t);
+    }
+
+    // localtime_r through the cached offset
+    static std::tm local_time(std::time_t t) noexcept
+    {
+        const offset_t& o = offset(t);
+
+        std::tm tms = civil::to_tm(static_cast<civil::seconds_t>(t) +
+            o.gmtoff);
+        tms.tm_isdst = o.isdst;
+#if !defined(WIN32) && !defined(_WIN32)
+        tms.tm_gmtoff = o.gmtoff;
+        tms.tm_zone = o.zone;
+#endif
+        return tms;
+    }
+
+    // drops the cached offsets of all threads
+    static void invalidate() noexcept
+    {
+        generation().fetch_add(1, std::memory_order_release);
+    }
+};
+
+/*
+ *  local seconds (civil::from_tm of a wall clock time) to utc
+ *  without mktime, for any offset(t) source like zone_cache::offset
+ *  or tzif::offset; the offsets a day before and a day after
+ *  give the candidates, so transitions closer than two days are missed;
+ *  zone_cache keeps both sides of a transition, so near one
+ *  all the probes stay inside the cached ranges
+ *
+ *  unique    first == second
+ *  ambiguous the wall time happens twice (fall back),
+ *            first with the offset before the transition, second after
+ *  skipped   the wall time does not exist (spring forward),
+ *            first read with the offset after, second with the one before
+ */
+
+struct local_info
+{
+    enum kind_t
+    {
+        unique,
+        ambiguous,
+        skipped
+    };
+
+    kind_t kind;
+    std::time_t first;
+    std::time_t second;
+    // of the offsets first and second are read with
+    int first_isdst;
+    int second_isdst;
+};
+
+template<class Offset>
+static inline local_info local_to_utc(civil::seconds_t local,
+    Offset&& offset) noexcept
+{
+    const zone_cache::offset_t before = offset(static_cast<std::time_t>(
+        local - civil::seconds_per_day));
+    const zone_cache::offset_t after = offset(static_cast<std::time_t>(
+        local + civil::seconds_per_day));
+
+    const std::time_t a = static_cast<std::time_t>(local - before.gmtoff);
+    const std::time_t b = static_cast<std::time_t>(local - after.gmtoff);
+    if (before.gmtoff == after.gmtoff)
+        return local_info{local_info::unique, a, a,
+            before.isdst, before.isdst};
+
+    const bool va = (offset(a).gmtoff == before.gmtoff);
+    const bool vb = (offset(b).gmtoff == after.gmtoff);
+
+    if (va && vb)
+        return local_info{local_info::ambiguous, a, b,
+            before.isdst, after.isdst};
+    if (va)
+        return local_info{local_info::unique, a, a,
+            before.isdst, before.isdst};
+    if (vb)
+        return local_info{local_info::unique, b, b,
+            after.isdst, after.isdst};
+
+    return local_info{local_info::skipped, b, a, after.isdst, before.isdst};
+}
+
+// like mktime, tm_isdst chooses the offset for ambiguous and skipped times
+// without it the earlier of two and the later side of a gap;
+// glibc mktime with tm_isdst < 0 takes the offset its previous call used,
+// so in a repeated hour it may give the later time where this gives
+// the earlier (seen for Europe/Dublin, where winter time has tm_isdst 1)
+static inline std::time_t pick(const local_info& info, int isdst) noexcept
+{
+    if (info.kind == local_info::unique)
+        return info.first;
+
+    if (isdst >= 0)
+    {
+        if ((info.first_isdst > 0) == (isdst > 0))
+            return info.first;
+        if ((info.second_isdst > 0) == (isdst > 0))
+            return info.second;
+    }
+
+    return (info.kind == local_info::ambiguous) ? info.first : info.second;
+}
+
+static inline std::tm empty_tm_dst() noexcept
+{
+    std::tm tmdst{};
+    // mktime-like conversions need the DST flag of the moment
+    // the time stamp is made, the cached offset of now gives it
+    tmdst.tm_isdst = zone_cache::offset(std::time(nullptr)).isdst;
+    return tmdst;
+}
+
+} // namespace time
+} // namespace util
+} // namespace btdef